@@ -6,6 +6,10 @@
 #include "../src/global_const.h"
 #include "board_intern.h"
 #include "board.h"
+#include "hash.h"
+#include "pattern.h"
+#include "network.h"
+#include "eyes.h"
 
 
 /**
@@ -29,17 +33,46 @@
 #define WHITE_INDEX 0   //!< Array index for WHITE; must be WHITE + 1
 #define EMPTY_INDEX 1   //!< Array index for EMPTY; must be EMPTY + 1
 
+#define BLACK_BORDER 1  //!< Flag for an empty region next to a black stone.
+#define WHITE_BORDER 2  //!< Flag for an empty region next to a white stone.
+
+#define AREA_DISTANCE_MAX 4 //!< Maximum distance of an empty vertex to the stones it counts for.
+
 //////////////////////////////
 //                          //
 //  Board data structures   //
 //                          //
 //////////////////////////////
 
-bsize_t board_size = BOARD_SIZE_DEFAULT;    //!< Sets the boardsize to the default.
-int index_1d_max;   //!< The maximum 1d index without highest off board row.
+// All data structures that describe a position are thread local, so every
+// search thread works on its own copy of the board. See get_board_snapshot().
+
+__thread bsize_t board_size = BOARD_SIZE_DEFAULT;   //!< Sets the boardsize to the default.
+__thread int index_1d_max;  //!< The maximum 1d index without highest off board row.
+
+__thread int *board;        //!< Board data structures wich holds color per field.
+__thread int *board_hoshi;  //!< Board that defines star points.
 
-int *board;         //!< Board data structures wich holds color per field.
-int *board_hoshi;   //!< Board that defines star points.
+__thread hash_t hash_id;    //!< Zobrist hash id of the current board.
+
+__thread unsigned short *board_pattern;     //!< 3x3 pattern of the neighbours per field, see pattern.c.
+static __thread int pattern_offset[8];      //!< Index offset per pattern direction.
+
+//! Zobrist random numbers for (WHITE_INDEX,EMPTY_INDEX,BLACK_INDEX) per 1d index; shared by all threads.
+static hash_t zobrist[3][ ( BOARD_SIZE_MAX + 1 ) * ( BOARD_SIZE_MAX + 2 ) ];
+static bool   is_zobrist_init = false;  //!< Indicates if zobrist[][] is filled.
+
+static void init_zobrist(void);
+static void init_board_patterns(void);
+static void update_pattern( int index_1d, int old_color, int new_color );
+static void init_eval_data(void);
+static void init_stone_weight( int term );
+static void update_eval_data( int index_1d, int old_color, int new_color );
+static int  get_border( int color );
+static void get_nearest_colors( const unsigned char region[], unsigned char borders[] );
+static void update_pass_alive(void);
+static void find_pass_alive( int color );
+static void count_worm_stats(void);
 
 // TEST!
 int  remove_worm( int index_1d );
@@ -53,12 +86,15 @@ void update_worm_data( int index_1d, int color_index );
 //////////////////////////////
 
 
-worm_nr_t MAX_WORM_COUNT;   //!< Stores the maximum of possible worms for one color.
+__thread worm_nr_t MAX_WORM_COUNT;  //!< Stores the maximum of possible worms for one color.
+
+__thread worm_nr_t *worm_board[3] ; //!< Three 1D-Boards with worm numbers (for WHITE_INDEX,EMPTY_INDEX,BLACK_INDEX).
+__thread worm_nr_t worm_nr_max[3];  //!< List of current highest worm numbers (for WHITE_INDEX,EMPTY_INDEX,BLACK_INDEX).
 
-worm_nr_t *worm_board[3] ;  //!< Three 1D-Boards with worm numbers (for WHITE_INDEX,EMPTY_INDEX,BLACK_INDEX).
-worm_nr_t worm_nr_max[3];   //!< List of current highest worm numbers (for WHITE_INDEX,EMPTY_INDEX,BLACK_INDEX).
+//! Number of entries in a worm list.
+#define WORM_LIST_SIZE  ( BOARD_SIZE_MAX * BOARD_SIZE_MAX / 2 )
 
-worm_t worm_list[3][BOARD_SIZE_MAX * BOARD_SIZE_MAX / 2];       //!< List of worm structs for black. Index is worm_nr.
+__thread worm_t *worm_list[3];      //!< Lists of worm structs (for WHITE_INDEX,EMPTY_INDEX,BLACK_INDEX). Index is worm_nr.
 
 
 //! Struct with coordinates for different board types and additional data.
@@ -74,13 +110,36 @@ typedef struct {
 //                          //
 //////////////////////////////
 
-int count_color[3];     //!< Number of WHITE, EMPTY, BLACK on board.
+__thread int count_color[3];    //!< Number of WHITE, EMPTY, BLACK on board.
 
-int captured_by_black;  //!< Number of white stones captured by black.
-int captured_by_white;  //!< Number of black stones captured by white.
+__thread int captured_by_black; //!< Number of white stones captured by black.
+__thread int captured_by_white; //!< Number of black stones captured by white.
 
-int *removed[3];        //!< List of 1d-indexes where stones have been removed by remove_stones().
-int removed_max[3];     //!< Counts the number of elements in *removed[3].
+__thread int *removed[3];       //!< List of 1d-indexes where stones have been removed by remove_stones().
+__thread int removed_max[3];    //!< Counts the number of elements in *removed[3].
+
+// Evaluation terms that only depend on single stones are kept up to date by
+// every function that changes the board, see set_stone_weight(). The same
+// functions update the first layer of the network, see network.c.
+
+//! Weight function per evaluation term or NULL; shared by all threads.
+static int (*weight_function[COUNT_BRAINS])( int i, int j );
+
+__thread int *stone_weight[COUNT_BRAINS];   //!< Weight per 1d index for every term with weight function.
+__thread int stone_term[COUNT_BRAINS];      //!< Sum of color times weight of all stones per term.
+
+// Pass-alive stones and territory after Benson, computed for one position
+// and kept until the position changes, see update_pass_alive().
+
+//! Color of pass-alive stone or territory per 1d index, EMPTY for the rest.
+static __thread signed char pass_alive[ ( BOARD_SIZE_MAX + 1 ) * ( BOARD_SIZE_MAX + 2 ) ];
+static __thread hash_t pass_alive_key;          //!< Hash id of the position of pass_alive[].
+static __thread bool   is_pass_alive_valid;     //!< Indicates if pass_alive[] belongs to a position.
+
+// Sums over the worms of each color, counted by scan_board_1() together with
+// the worm list, so the evaluation can read them without a walk over the
+// worms, see get_worm_stats().
+static __thread worm_stats_t worm_stats[3];     //!< Worm sums for WHITE_INDEX, EMPTY_INDEX (unused), BLACK_INDEX.
 
 
 /**
@@ -111,10 +170,11 @@ void init_board( bsize_t board_size )
 
     board            = malloc( ( (board_size+1) * (board_size+2) * sizeof(int) ) );
     board_hoshi      = malloc( ( (board_size+1) * (board_size+2) * sizeof(int) ) );
+    board_pattern    = malloc( ( (board_size+1) * (board_size+2) * sizeof(unsigned short) ) );
     worm_board[BLACK_INDEX] = malloc( ( (board_size+1) * (board_size+2) * sizeof(worm_nr_t) ) );
     worm_board[WHITE_INDEX] = malloc( ( (board_size+1) * (board_size+2) * sizeof(worm_nr_t) ) );
     worm_board[EMPTY_INDEX] = malloc( ( (board_size+1) * (board_size+2) * sizeof(worm_nr_t) ) );
-    if ( board == NULL || board_hoshi == NULL ) {
+    if ( board == NULL || board_hoshi == NULL || board_pattern == NULL ) {
         fprintf( stderr, "cannot allocate memory for board\n" );
         exit(EXIT_FAILURE);
     }
@@ -123,6 +183,18 @@ void init_board( bsize_t board_size )
         exit(EXIT_FAILURE);
     }
 
+    // The worm lists do not depend on the board size; they are kept on the
+    // heap, so the thread local data of a search thread stays small:
+    if ( worm_list[BLACK_INDEX] == NULL ) {
+        worm_list[BLACK_INDEX] = calloc( WORM_LIST_SIZE, sizeof(worm_t) );
+        worm_list[WHITE_INDEX] = calloc( WORM_LIST_SIZE, sizeof(worm_t) );
+        worm_list[EMPTY_INDEX] = calloc( WORM_LIST_SIZE, sizeof(worm_t) );
+        if ( worm_list[BLACK_INDEX] == NULL || worm_list[WHITE_INDEX] == NULL || worm_list[EMPTY_INDEX] == NULL ) {
+            fprintf( stderr, "cannot allocate memory for worm_list\n" );
+            exit(EXIT_FAILURE);
+        }
+    }
+
     // Initialise board data structures:
     for ( index_1d = 0; index_1d <= board_index_max; index_1d++ ) {
         if ( index_1d <= board_size ) {
@@ -150,8 +222,17 @@ void init_board( bsize_t board_size )
     worm_nr_max[WHITE_INDEX] = 0;
     worm_nr_max[EMPTY_INDEX] = 0;
 
-    // Define star points:
+    // The empty board has hash id zero:
+    init_zobrist();
+    hash_id = 0;
+
+    init_board_patterns();
+
+    // Star points update the stone weights, so they are set afterwards:
+    init_eval_data();
     init_hoshi();
+    is_pass_alive_valid = false;
+    memset( worm_stats, 0, sizeof(worm_stats) );
 
     // Initialise worms array:
     if ( board_size & (bsize_t) 1 ) {
@@ -218,15 +299,30 @@ void init_hoshi(void)
 /**
  * @brief       Defines vertex as hoshi
  *
- * Defines the the given vertex as star point.
+ * Defines the the given vertex as star point. Weight functions may depend
+ * on star points, so the stone weights of the vertex are computed again.
  *
  * @param[in]   i   Horizontal coordinate
  * @param[in]   j   Vertical coordinate
  * @return      Nothing
+ * @sa          set_stone_weight()
  */
 void set_hoshi( int i, int j )
 {
-    board_hoshi[ INDEX(i,j) ] = 1;
+    int term;
+    int weight;
+    int index_1d = INDEX(i,j);
+
+    board_hoshi[index_1d] = 1;
+
+    for ( term = 0; term < COUNT_BRAINS; term++ ) {
+        if ( stone_weight[term] == NULL ) {
+            continue;
+        }
+        weight = weight_function[term]( i, j );
+        stone_term[term] += board[index_1d] * ( weight - stone_weight[term][index_1d] );
+        stone_weight[term][index_1d] = weight;
+    }
 
     return;
 }
@@ -244,11 +340,15 @@ void set_hoshi( int i, int j )
  */
 void free_board(void)
 {
+    int k;
+
     free(board);
     free(board_hoshi);
+    free(board_pattern);
 
-    board       = NULL;
-    board_hoshi = NULL;
+    board         = NULL;
+    board_hoshi   = NULL;
+    board_pattern = NULL;
 
     free(worm_board[BLACK_INDEX]);
     free(worm_board[WHITE_INDEX]);
@@ -258,6 +358,14 @@ void free_board(void)
     worm_board[WHITE_INDEX] = NULL;
     worm_board[EMPTY_INDEX] = NULL;
 
+    free(worm_list[BLACK_INDEX]);
+    free(worm_list[WHITE_INDEX]);
+    free(worm_list[EMPTY_INDEX]);
+
+    worm_list[BLACK_INDEX] = NULL;
+    worm_list[WHITE_INDEX] = NULL;
+    worm_list[EMPTY_INDEX] = NULL;
+
     free(removed[BLACK_INDEX]);
     free(removed[EMPTY_INDEX]);
     free(removed[WHITE_INDEX]);
@@ -266,6 +374,11 @@ void free_board(void)
     removed[EMPTY_INDEX] = NULL;
     removed[BLACK_INDEX] = NULL;
 
+    for ( k = 0; k < COUNT_BRAINS; k++ ) {
+        free(stone_weight[k]);
+        stone_weight[k] = NULL;
+    }
+
     return;
 }
 
@@ -401,6 +514,8 @@ void scan_board_1(void)
         }
     }
 
+    count_worm_stats();
+
     return;
 }
 
@@ -551,7 +666,10 @@ int remove_worm( int index_1d )
     int color         = board[index_1d];
     worm_nr_t worm_nr = worm_board[ color + 1 ][index_1d];
 
+    update_pattern( index_1d, color, EMPTY );
+    update_eval_data( index_1d, color, EMPTY );
     board[index_1d] = EMPTY;
+    hash_id ^= zobrist[ color + 1 ][index_1d];
     worm_board[ color + 1 ][index_1d] = EMPTY;
     //worm_board[EMPTY_INDEX][index_1d] = get_free_worm_nr(EMPTY);
     worm_board[EMPTY_INDEX][index_1d] = get_free_worm_nr(EMPTY);
@@ -975,7 +1093,7 @@ inline int get_worm_neighbours( int index_1d, worm_nr_t worm_nr, int color_i )
  * @brief       Returns number of stones for color
  *
  * Returns the number of stones for a given color, or number of empty fields
- * if color is EMPTY.
+ * if color is EMPTY. The counts are updated with every change of the board.
  *
  * @param[in]   color   BLACK|WHITE|EMPTY
  * @return      Number of stones or fields
@@ -985,6 +1103,589 @@ int get_stone_count( int color )
     return count_color[color+1];
 }
 
+/**
+ * @brief       Sets the weight function of an evaluation term.
+ *
+ * Every stone adds its color (BLACK = 1, WHITE = -1) times the weight of its
+ * vertex to the term. The term is updated whenever a stone is set, removed
+ * or put back, so reading it does not need a walk over the board. A NULL
+ * weight function removes the term.
+ *
+ * @param[in]   term    Index of term (brain index)
+ * @param[in]   weight  Weight function for a vertex or NULL
+ * @return      Nothing
+ * @sa          get_stone_term()
+ * @note        Boards of other threads get the weights with their next call
+ *              of init_board().
+ */
+void set_stone_weight( int term, int (*weight)( int i, int j ) )
+{
+    weight_function[term] = weight;
+
+    if ( board != NULL ) {
+        init_stone_weight(term);
+    }
+
+    return;
+}
+
+/**
+ * @brief       Returns the value of an evaluation term.
+ *
+ * @param[in]   term    Index of term (brain index)
+ * @return      Sum of color times weight of all stones
+ * @sa          set_stone_weight()
+ */
+int get_stone_term( int term )
+{
+
+    return stone_term[term];
+}
+
+/**
+ * @brief       Estimates the area of black minus the area of white.
+ *
+ * Every stone counts for its color. An empty region (an EMPTY worm) that
+ * only borders stones of one color counts for this color. In a region that
+ * borders both colors an empty vertex counts for the color whose stones
+ * are nearer (see get_nearest_colors()). Vertices at the same distance to
+ * both colors or more than AREA_DISTANCE_MAX steps away from all stones
+ * are neutral.
+ *
+ * Pass-alive stones and territory (see get_pass_alive()) count exactly for
+ * their color, including dead stones of the other color inside.
+ *
+ * @return      Estimated area of black minus area of white
+ * @note        The worm data must be up to date, i.e. scan_board_1() must
+ *              have been called after the last change of the board.
+ * @note        On a finished game this is the area score without komi.
+ */
+int get_area_estimate(void)
+{
+    int index_1d;
+    int color;
+    int border;
+    int area              = 0;
+    bool is_contested     = false;
+    worm_nr_t *empty_worm = worm_board[EMPTY_INDEX];
+    worm_nr_t empty_max   = worm_nr_max[EMPTY_INDEX];
+    unsigned char region[ empty_max + 1 ];      // Border flags per EMPTY worm.
+    unsigned char neighbours[index_1d_max];     // Border flags per empty vertex.
+
+    memset( region, 0, sizeof(region) );
+    update_pass_alive();
+
+    // Colors next to every empty vertex and every empty region:
+    for ( index_1d = board_size + 1; index_1d < index_1d_max; index_1d++ ) {
+        if ( board[index_1d] != EMPTY ) {
+            continue;
+        }
+        border = get_border( board[ index_1d + board_size + 1 ] )
+               | get_border( board[ index_1d + 1 ] )
+               | get_border( board[ index_1d - board_size - 1 ] )
+               | get_border( board[ index_1d - 1 ] );
+        neighbours[index_1d]            = border;
+        region[ empty_worm[index_1d] ] |= border;
+        if ( region[ empty_worm[index_1d] ] == ( BLACK_BORDER | WHITE_BORDER ) ) {
+            is_contested = true;
+        }
+    }
+
+    if ( is_contested ) {
+        get_nearest_colors( region, neighbours );
+    }
+
+    for ( index_1d = board_size + 1; index_1d < index_1d_max; index_1d++ ) {
+        color = board[index_1d];
+        if ( color == BOARD_OFF ) {
+            continue;
+        }
+        if ( pass_alive[index_1d] != EMPTY ) {
+            area += pass_alive[index_1d];
+            continue;
+        }
+        if ( color != EMPTY ) {
+            area += color;
+            continue;
+        }
+
+        border = region[ empty_worm[index_1d] ];
+        if ( border == ( BLACK_BORDER | WHITE_BORDER ) ) {
+            border = neighbours[index_1d];
+        }
+        area += ( border == BLACK_BORDER ) - ( border == WHITE_BORDER );
+    }
+
+    return area;
+}
+
+/**
+ * @brief       Returns the owner of a pass-alive vertex.
+ *
+ * A stone is pass-alive if it cannot be captured even if its color passes
+ * all the time (Benson's algorithm). Territory is pass-alive if every empty
+ * vertex of its region is a liberty of one pass-alive worm, so the other
+ * color cannot make an eye there. Stones of the other color inside are
+ * dead.
+ *
+ * The result is computed once per position and kept until the hash id of
+ * the board changes.
+ *
+ * @param[in]   i   Horizontal coordinate
+ * @param[in]   j   Vertical coordinate
+ * @return      BLACK|WHITE if pass-alive for this color, EMPTY otherwise
+ * @note        The worm data must be up to date, i.e. scan_board_1() must
+ *              have been called after the last change of the board.
+ */
+int get_pass_alive( int i, int j )
+{
+
+    update_pass_alive();
+
+    return pass_alive[ INDEX(i,j) ];
+}
+
+/**
+ * @brief       Checks if a vertex is the vital point of an unsettled eye shape.
+ *
+ * The empty region of the vertex is looked up in the eye shape table (see
+ * eyes.c) if it has at most EYE_SIZE_MAX vertices and only borders stones
+ * of one color. If its shape is unsettled, the vital point decides about
+ * life: for the owner of the region it is the defending move, for the
+ * other color the killing move. Regions with stones of the other color
+ * inside and the influence of the board edge are not considered.
+ *
+ * @param[in]   color   Color of moving side (BLACK|WHITE)
+ * @param[in]   i       Horizontal coordinate of an empty vertex
+ * @param[in]   j       Vertical coordinate of an empty vertex
+ * @return      true|false
+ * @note        The worm data must be up to date, i.e. scan_board_1() must
+ *              have been called after the last change of the board.
+ */
+bool is_eye_vital_point( int color, int i, int j )
+{
+    int l;
+    int index_1d;
+    int border;
+    int owner;
+    int vital;
+    int cells[EYE_SIZE_MAX][2];
+    int canonical[EYE_SIZE_MAX][2];
+    worm_t *w = &worm_list[EMPTY_INDEX][ worm_board[EMPTY_INDEX][ INDEX(i,j) ] ];
+    const eye_shape_t *shape;
+
+    if ( w->count > EYE_SIZE_MAX ) {
+        return false;
+    }
+
+    border = 0;
+    for ( l = 0; l < w->count; l++ ) {
+        index_1d = w->index[l];
+        border  |= get_border( board[ index_1d + board_size + 1 ] )
+                 | get_border( board[ index_1d + 1 ] )
+                 | get_border( board[ index_1d - board_size - 1 ] )
+                 | get_border( board[ index_1d - 1 ] );
+        cells[l][0] = index_1d % ( board_size + 1 );
+        cells[l][1] = index_1d / ( board_size + 1 ) - 1;
+    }
+    if ( border == BLACK_BORDER ) {
+        owner = BLACK;
+    }
+    else if ( border == WHITE_BORDER ) {
+        owner = WHITE;
+    }
+    else {
+        return false;
+    }
+
+    shape = get_eye_shape( get_eye_key( w->count, (const int (*)[2])cells, canonical ) );
+    if ( shape == NULL || shape->status != EYE_UNSETTLED ) {
+        return false;
+    }
+    vital = ( owner == color ) ? shape->defend_vital : shape->attack_vital;
+    for ( l = 0; l < w->count; l++ ) {
+        if ( cells[l][0] == i && cells[l][1] == j ) {
+            return canonical[l][1] * 8 + canonical[l][0] == vital;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief       Computes pass-alive stones and territory if necessary.
+ *
+ * @return      Nothing
+ * @sa          get_pass_alive()
+ */
+void update_pass_alive(void)
+{
+
+    if ( is_pass_alive_valid && pass_alive_key == hash_id ) {
+        return;
+    }
+
+    memset( pass_alive, EMPTY, sizeof(pass_alive) );
+    find_pass_alive(BLACK);
+    find_pass_alive(WHITE);
+
+    pass_alive_key      = hash_id;
+    is_pass_alive_valid = true;
+
+    return;
+}
+
+/**
+ * @brief       Finds pass-alive worms and territory of one color.
+ *
+ * Regions are the connected areas of vertices without a stone of the given
+ * color, they consist of EMPTY worms and worms of the other color. A region
+ * is vital to a worm if all its empty vertices are liberties of the worm.
+ * Then after Benson all worms with less than two vital regions are dropped,
+ * and all regions next to a dropped worm, until nothing changes. The worms
+ * left are pass-alive.
+ *
+ * @param[in]   color   BLACK|WHITE
+ * @return      Nothing
+ */
+void find_pass_alive( int color )
+{
+    int k, n;
+    int m;
+    int r;
+    int p;
+    int index_1d;
+    int neighbour[4];
+    int seen[4];
+    int count_seen;
+    int count_regions = 0;
+    int count_order   = 0;
+    int count_pairs   = 0;
+    bool is_changed;
+    bool is_vital;
+    worm_nr_t *color_worm = worm_board[ color + 1 ];
+
+    int  region_of[index_1d_max];           // Region number + 1 per vertex.
+    int  order[index_1d_max];               // Vertices sorted by region.
+    int  region_start[ index_1d_max + 1 ];  // First entry in order[] per region.
+    int  region_empty[index_1d_max];        // Number of empty vertices per region.
+    int  region_pairs[ index_1d_max + 1 ];  // First pair per region.
+    bool region_ok[index_1d_max];           // Region is enclosed by living worms.
+    int  pair_worm[ 4 * index_1d_max ];     // Worm next to a region.
+    int  pair_liberties[ 4 * index_1d_max ];    // Empty vertices of region next to worm.
+    bool worm_alive[ MAX_WORM_COUNT + 1 ];
+    int  worm_vital[ MAX_WORM_COUNT + 1 ];
+
+    memset( region_of, 0, sizeof(region_of) );
+
+    // Regions by flood fill, the vertices of a region are contiguous in order[]:
+    for ( index_1d = board_size + 1; index_1d < index_1d_max; index_1d++ ) {
+        if ( board[index_1d] == BOARD_OFF || board[index_1d] == color || region_of[index_1d] ) {
+            continue;
+        }
+
+        region_start[count_regions] = count_order;
+        region_of[index_1d]         = count_regions + 1;
+        order[ count_order++ ]      = index_1d;
+        for ( k = region_start[count_regions]; k < count_order; k++ ) {
+            neighbour[0] = order[k] + board_size + 1;
+            neighbour[1] = order[k] + 1;
+            neighbour[2] = order[k] - board_size - 1;
+            neighbour[3] = order[k] - 1;
+            for ( n = 0; n < 4; n++ ) {
+                if ( board[ neighbour[n] ] != BOARD_OFF && board[ neighbour[n] ] != color
+                        && ! region_of[ neighbour[n] ] ) {
+                    region_of[ neighbour[n] ] = count_regions + 1;
+                    order[ count_order++ ]    = neighbour[n];
+                }
+            }
+        }
+        count_regions++;
+    }
+    region_start[count_regions] = count_order;
+
+    // Worms next to every region and their liberties in it:
+    for ( r = 0; r < count_regions; r++ ) {
+        region_pairs[r] = count_pairs;
+        region_empty[r] = 0;
+        region_ok[r]    = true;
+
+        for ( k = region_start[r]; k < region_start[ r + 1 ]; k++ ) {
+            index_1d = order[k];
+            if ( board[index_1d] == EMPTY ) {
+                region_empty[r]++;
+            }
+
+            neighbour[0] = index_1d + board_size + 1;
+            neighbour[1] = index_1d + 1;
+            neighbour[2] = index_1d - board_size - 1;
+            neighbour[3] = index_1d - 1;
+            count_seen   = 0;
+            for ( n = 0; n < 4; n++ ) {
+                if ( board[ neighbour[n] ] != color || color_worm[ neighbour[n] ] == 0 ) {
+                    continue;
+                }
+                for ( m = 0; m < count_seen; m++ ) {
+                    if ( seen[m] == color_worm[ neighbour[n] ] ) {
+                        break;
+                    }
+                }
+                if ( m < count_seen ) {
+                    continue;
+                }
+                seen[ count_seen++ ] = color_worm[ neighbour[n] ];
+
+                for ( p = region_pairs[r]; p < count_pairs; p++ ) {
+                    if ( pair_worm[p] == color_worm[ neighbour[n] ] ) {
+                        break;
+                    }
+                }
+                if ( p == count_pairs ) {
+                    pair_worm[p]      = color_worm[ neighbour[n] ];
+                    pair_liberties[p] = 0;
+                    count_pairs++;
+                }
+                if ( board[index_1d] == EMPTY ) {
+                    pair_liberties[p]++;
+                }
+            }
+        }
+    }
+    region_pairs[count_regions] = count_pairs;
+
+    for ( k = 0; k <= MAX_WORM_COUNT; k++ ) {
+        worm_alive[k] = true;
+    }
+
+    do {
+        is_changed = false;
+
+        for ( k = 0; k <= MAX_WORM_COUNT; k++ ) {
+            worm_vital[k] = 0;
+        }
+        for ( r = 0; r < count_regions; r++ ) {
+            if ( ! region_ok[r] ) {
+                continue;
+            }
+            for ( p = region_pairs[r]; p < region_pairs[ r + 1 ]; p++ ) {
+                if ( region_empty[r] > 0 && pair_liberties[p] == region_empty[r] ) {
+                    worm_vital[ pair_worm[p] ]++;
+                }
+            }
+        }
+
+        // Worms with less than two vital regions can be captured:
+        for ( p = 0; p < count_pairs; p++ ) {
+            if ( worm_alive[ pair_worm[p] ] && worm_vital[ pair_worm[p] ] < 2 ) {
+                worm_alive[ pair_worm[p] ] = false;
+                is_changed = true;
+            }
+        }
+
+        // Regions next to such a worm are no longer safe:
+        for ( r = 0; r < count_regions; r++ ) {
+            if ( ! region_ok[r] ) {
+                continue;
+            }
+            for ( p = region_pairs[r]; p < region_pairs[ r + 1 ]; p++ ) {
+                if ( ! worm_alive[ pair_worm[p] ] ) {
+                    region_ok[r] = false;
+                    is_changed   = true;
+                    break;
+                }
+            }
+        }
+    } while ( is_changed );
+
+    for ( r = 0; r < count_regions; r++ ) {
+        if ( ! region_ok[r] ) {
+            continue;
+        }
+        is_vital = false;
+        for ( p = region_pairs[r]; p < region_pairs[ r + 1 ]; p++ ) {
+            if ( region_empty[r] > 0 && pair_liberties[p] == region_empty[r] ) {
+                is_vital = true;
+            }
+        }
+        if ( is_vital ) {
+            for ( k = region_start[r]; k < region_start[ r + 1 ]; k++ ) {
+                pass_alive[ order[k] ] = color;
+            }
+        }
+    }
+
+    for ( index_1d = board_size + 1; index_1d < index_1d_max; index_1d++ ) {
+        if ( board[index_1d] == color && worm_vital[ color_worm[index_1d] ] >= 2 ) {
+            pass_alive[index_1d] = color;
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief       Returns the border flag of a color.
+ *
+ * @param[in]   color   BLACK|WHITE|EMPTY or BOARD_OFF
+ * @return      BLACK_BORDER|WHITE_BORDER|0
+ */
+int get_border( int color )
+{
+
+    return ( color == BLACK ) ? BLACK_BORDER : ( color == WHITE ) ? WHITE_BORDER : 0;
+}
+
+/**
+ * @brief       Finds the nearest color of the empty vertices between colors.
+ *
+ * Works on the empty regions that border both colors. Starting from the
+ * vertices next to stones, the border flags are spread over the empty
+ * vertices by a breadth-first search. A vertex gets the flags of all its
+ * neighbours one step nearer to the stones, so it gets both flags if both
+ * colors are equally near. The search stops at AREA_DISTANCE_MAX steps;
+ * vertices farther away keep no flag.
+ *
+ * @param[in]       region      Border flags per EMPTY worm
+ * @param[in,out]   borders     Border flags of the neighbours per empty
+ *                              vertex; flags of the nearest colors after
+ * @return          Nothing
+ * @sa              get_area_estimate()
+ */
+void get_nearest_colors( const unsigned char region[], unsigned char borders[] )
+{
+    int index_1d;
+    int next;
+    int k;
+    int head = 0;
+    int tail = 0;
+    int queue[ BOARD_SIZE_MAX * BOARD_SIZE_MAX ];
+    int offset[4] = { board_size + 1, 1, - board_size - 1, -1 };
+    worm_nr_t *empty_worm = worm_board[EMPTY_INDEX];
+    unsigned char distance[index_1d_max];
+
+    for ( index_1d = board_size + 1; index_1d < index_1d_max; index_1d++ ) {
+        if ( board[index_1d] != EMPTY
+                || region[ empty_worm[index_1d] ] != ( BLACK_BORDER | WHITE_BORDER ) ) {
+            continue;
+        }
+        distance[index_1d] = AREA_DISTANCE_MAX + 1;
+        if ( borders[index_1d] != 0 ) {
+            distance[index_1d] = 1;
+            queue[tail++]      = index_1d;
+        }
+    }
+
+    // The queue holds the vertices in the order of their distance, so all
+    // flags of a vertex are known before it is taken from the queue:
+    while ( head < tail ) {
+        index_1d = queue[head++];
+        if ( distance[index_1d] == AREA_DISTANCE_MAX ) {
+            continue;
+        }
+        for ( k = 0; k < 4; k++ ) {
+            next = index_1d + offset[k];
+            if ( board[next] != EMPTY ) {
+                continue;
+            }
+            if ( distance[next] > distance[index_1d] + 1 ) {
+                distance[next] = distance[index_1d] + 1;
+                borders[next]  = borders[index_1d];
+                queue[tail++]  = next;
+            }
+            else if ( distance[next] == distance[index_1d] + 1 ) {
+                borders[next] |= borders[index_1d];
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief       Initialises the evaluation data of the empty board.
+ *
+ * @return      Nothing
+ */
+void init_eval_data(void)
+{
+    int k;
+
+    count_color[BLACK_INDEX] = 0;
+    count_color[WHITE_INDEX] = 0;
+    count_color[EMPTY_INDEX] = board_size * board_size;
+
+    for ( k = 0; k < COUNT_BRAINS; k++ ) {
+        init_stone_weight(k);
+    }
+
+    refresh_network();
+
+    return;
+}
+
+/**
+ * @brief       Computes the weights and the value of an evaluation term.
+ *
+ * @param[in]   term    Index of term (brain index)
+ * @return      Nothing
+ */
+void init_stone_weight( int term )
+{
+    int i, j;
+
+    free(stone_weight[term]);
+    stone_weight[term] = NULL;
+    stone_term[term]   = 0;
+
+    if ( weight_function[term] == NULL ) {
+        return;
+    }
+
+    stone_weight[term] = calloc( (board_size+1) * (board_size+2), sizeof(int) );
+    if ( stone_weight[term] == NULL ) {
+        fprintf( stderr, "cannot allocate memory for stone weights\n" );
+        exit(EXIT_FAILURE);
+    }
+
+    for ( i = 0; i < board_size; i++ ) {
+        for ( j = 0; j < board_size; j++ ) {
+            stone_weight[term][ INDEX(i,j) ] = weight_function[term]( i, j );
+            stone_term[term] += board[ INDEX(i,j) ] * stone_weight[term][ INDEX(i,j) ];
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief       Updates the evaluation data for a changed field.
+ *
+ * @param[in]   index_1d    Field whose color changes
+ * @param[in]   old_color   Color before the change
+ * @param[in]   new_color   Color after the change
+ * @return      Nothing
+ */
+void update_eval_data( int index_1d, int old_color, int new_color )
+{
+    int k;
+
+    count_color[ old_color + 1 ]--;
+    count_color[ new_color + 1 ]++;
+
+    for ( k = 0; k < COUNT_BRAINS; k++ ) {
+        if ( stone_weight[k] != NULL ) {
+            stone_term[k] += ( new_color - old_color ) * stone_weight[k][index_1d];
+        }
+    }
+
+    if ( is_network_loaded() ) {
+        update_network( index_1d % ( board_size + 1 ), ( index_1d / ( board_size + 1 ) ) - 1
+            , old_color, new_color );
+    }
+
+    return;
+}
+
 /**
  * @brief       Returns number of worms in atari.
  *
@@ -993,23 +1694,191 @@ int get_stone_count( int color )
  * @param[in]   color   BLACK|WHITE
  * @return      Number of worms
  * @note        Color EMPTY as parameter does not make sense here.
+ * @note        The worm data must be up to date, i.e. scan_board_1() must
+ *              have been called after the last change of the board.
  */
 int get_worm_count_atari( int color )
+{
+
+    return worm_stats[color+1].atari_worms;
+}
+
+/**
+ * @brief       Returns the sums over all worms of a color.
+ *
+ * The sums are counted by scan_board_1(), so this costs no walk over the
+ * worms. Worms without liberties, which are captured by the last move, are
+ * not counted.
+ *
+ * @param[in]   color   BLACK|WHITE
+ * @param[out]  stats   Sums over the worms
+ * @return      Nothing
+ * @note        The worm data must be up to date, i.e. scan_board_1() must
+ *              have been called after the last change of the board.
+ */
+void get_worm_stats( int color, worm_stats_t *stats )
+{
+    *stats = worm_stats[color+1];
+
+    return;
+}
+
+/**
+ * @brief       Sums up the worm list of both colors.
+ *
+ * @return      Nothing
+ * @sa          get_worm_stats()
+ */
+void count_worm_stats(void)
 {
     int k;
+    int color_index;
+    worm_t *w;
+    worm_stats_t *stats;
+
+    for ( color_index = WHITE_INDEX; color_index <= BLACK_INDEX; color_index += 2 ) {
+        w     = worm_list[color_index];
+        stats = &worm_stats[color_index];
+        memset( stats, 0, sizeof(worm_stats_t) );
+
+        // Every liberty counts 12 for the worm, see count_worm_liberties():
+        for ( k = 1; k <= worm_nr_max[color_index]; k++ ) {
+            if ( w[k].number == 0 || w[k].liberties == 0 ) {
+                continue;
+            }
+            stats->worms++;
+            stats->liberties += w[k].liberties / 12;
+            if ( w[k].liberties == 12 ) {
+                stats->atari_worms++;
+                stats->atari_stones += w[k].count;
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief       Returns the liberties of all worms with a given liberty count.
+ *
+ * For the given color all worms with exactly the given number of liberties
+ * are searched. Every liberty of these worms is written into the liberty
+ * list together with the size of its worm. A vertex that is a liberty of two
+ * worms is listed twice.
+ *
+ * @param[in]   color           BLACK|WHITE
+ * @param[in]   nr_of_liberties Number of liberties the worms must have
+ * @param[out]  liberties       List of liberties (i, j, size of worm)
+ * @return      Number of entries in liberty list
+ * @note        The worm data must be up to date, i.e. scan_board_1() must
+ *              have been called after the last change of the board.
+ */
+int get_worm_liberties( int color, int nr_of_liberties, int liberties[][3] )
+{
+    int k, l, m, n;
+    int index_1d;
+    int neighbour[4];
+    int found[4];
+    int count_found;
     int count       = 0;
     worm_t *w       = worm_list[color+1];
     worm_nr_t w_max = worm_nr_max[color+1];
 
+    if ( nr_of_liberties < 1 || nr_of_liberties > 4 ) {
+        return 0;
+    }
+
     for ( k = 1; k <= w_max; k++ ) {
-        if ( w[k].liberties == 12 ) {
-            count++;
+        if ( w[k].number == 0 || w[k].liberties != nr_of_liberties * 12 ) {
+            continue;
+        }
+
+        // Walk through the stones of the worm until all liberties are found:
+        count_found = 0;
+        for ( l = 0; l < w[k].count && count_found < nr_of_liberties; l++ ) {
+            index_1d     = w[k].index[l];
+            neighbour[0] = index_1d + board_size + 1;
+            neighbour[1] = index_1d + 1;
+            neighbour[2] = index_1d - board_size - 1;
+            neighbour[3] = index_1d - 1;
+
+            for ( m = 0; m < 4 && count_found < nr_of_liberties; m++ ) {
+                if ( board[ neighbour[m] ] != EMPTY ) {
+                    continue;
+                }
+                for ( n = 0; n < count_found; n++ ) {
+                    if ( found[n] == neighbour[m] ) {
+                        break;
+                    }
+                }
+                if ( n < count_found ) {
+                    continue;
+                }
+                found[count_found++] = neighbour[m];
+
+                liberties[count][0] = neighbour[m] % ( board_size + 1 );
+                liberties[count][1] = neighbour[m] / ( board_size + 1 ) - 1;
+                liberties[count][2] = w[k].count;
+                count++;
+            }
         }
     }
 
     return count;
 }
 
+/**
+ * @brief       Checks if a move is not a suicide.
+ *
+ * A move on an empty vertex is legal if the vertex has an empty neighbour,
+ * a neighbour worm of the same color with more than one liberty, or if it
+ * captures a neighbour worm of the other color. Ko is not checked here.
+ *
+ * @param[in]   color   BLACK|WHITE
+ * @param[in]   i       Horizontal coordinate
+ * @param[in]   j       Vertical coordinate
+ * @return      true|false
+ * @note        The worm data must be up to date, i.e. scan_board_1() must
+ *              have been called after the last change of the board.
+ */
+bool is_legal_move( int color, int i, int j )
+{
+    int k;
+    int index_1d = INDEX(i,j);
+    int neighbour[4];
+    int n_color;
+    worm_nr_t worm_nr;
+
+    if ( board[index_1d] != EMPTY ) {
+        return false;
+    }
+
+    neighbour[0] = index_1d + board_size + 1;
+    neighbour[1] = index_1d + 1;
+    neighbour[2] = index_1d - board_size - 1;
+    neighbour[3] = index_1d - 1;
+
+    for ( k = 0; k < 4; k++ ) {
+        n_color = board[ neighbour[k] ];
+        if ( n_color == BOARD_OFF ) {
+            continue;
+        }
+        if ( n_color == EMPTY ) {
+            return true;
+        }
+
+        worm_nr = worm_board[ n_color + 1 ][ neighbour[k] ];
+        if ( n_color == color && worm_list[ n_color + 1 ][worm_nr].liberties > 12 ) {
+            return true;
+        }
+        if ( n_color != color && worm_list[ n_color + 1 ][worm_nr].liberties == 12 ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 //@}
 
 
@@ -1039,7 +1908,14 @@ int get_worm_count_atari( int color )
  */
 void set_vertex( int color, int i, int j )
 {
-    board[ INDEX(i,j) ] = color;
+    int index_1d = INDEX(i,j);
+
+    hash_id ^= zobrist[ board[index_1d] + 1 ][index_1d];
+    hash_id ^= zobrist[ color + 1 ][index_1d];
+
+    update_pattern( index_1d, board[index_1d], color );
+    update_eval_data( index_1d, board[index_1d], color );
+    board[index_1d] = color;
 
     return;
 }
@@ -1060,6 +1936,83 @@ int get_vertex( int i, int j )
     return board[ INDEX(i,j) ];
 }
 
+/**
+ * @brief       Returns the 3x3 pattern of the given vertex.
+ *
+ * @param[in]   i   horizontal coordinate
+ * @param[in]   j   vertical coordinate
+ * @return      Pattern of the eight neighbours
+ * @sa          pattern.c
+ */
+unsigned short get_pattern( int i, int j )
+{
+
+    return board_pattern[ INDEX(i,j) ];
+}
+
+/**
+ * @brief       Computes the 3x3 patterns of all fields.
+ *
+ * Neighbours outside of the board array are off the board.
+ *
+ * @return      Nothing
+ */
+void init_board_patterns(void)
+{
+    int k;
+    int n;
+    int index_1d;
+    int index_1d_last = ( board_size + 1 ) * ( board_size + 2 ) - 1;
+
+    init_patterns();
+    get_pattern_offsets( board_size + 1, pattern_offset );
+
+    for ( index_1d = 0; index_1d <= index_1d_last; index_1d++ ) {
+        board_pattern[index_1d] = 0;
+        for ( k = 0; k < 8; k++ ) {
+            n = index_1d + pattern_offset[k];
+            if ( n < 0 || n > index_1d_last ) {
+                board_pattern[index_1d] |= PATTERN_OFF << ( 2 * k );
+            }
+            else {
+                board_pattern[index_1d] |= get_pattern_code( board[n] ) << ( 2 * k );
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief       Updates the 3x3 patterns of the neighbours of a field.
+ *
+ * @param[in]   index_1d    Field whose color changes
+ * @param[in]   old_color   Color before the change
+ * @param[in]   new_color   Color after the change
+ * @return      Nothing
+ * @note        Patterns of fields off the board are not updated.
+ */
+void update_pattern( int index_1d, int old_color, int new_color )
+{
+    int k;
+    int n;
+    unsigned int change = get_pattern_code(old_color) ^ get_pattern_code(new_color);
+
+    if ( change == 0 ) {
+        return;
+    }
+
+    for ( k = 0; k < 8; k++ ) {
+        n = index_1d + pattern_offset[k];
+        if ( n >= 0 && board[n] != BOARD_OFF ) {
+            // The field is in the opposite direction seen from n:
+            board_pattern[n] ^= change << ( 2 * ( ( k + 4 ) % 8 ) );
+        }
+    }
+
+    return;
+}
+
 /**
  * @brief       Returns the color of the given vertex.
  *
@@ -1263,7 +2216,10 @@ int remove_stones( int color )
             for ( l = 0; l < k; l++ ) {
                 if ( wb[index_1d] == zero_worm[l] ) {
                     //wb[index_1d]    = EMPTY;
+                    update_pattern( index_1d, color, EMPTY );
+                    update_eval_data( index_1d, color, EMPTY );
                     board[index_1d] = EMPTY;
+                    hash_id ^= zobrist[ color + 1 ][index_1d];
                     count_removed++;
 
                     removed[color+1][removed_max[color+1]++] = index_1d;
@@ -1282,6 +2238,43 @@ int remove_stones( int color )
     return count_removed;
 }
 
+/**
+ * @brief       Puts back the stones removed by remove_stones().
+ *
+ * The stones of the given color that have been removed by the last call of
+ * remove_stones() are set on the board again and the number of captured
+ * stones is corrected. This undoes the capture of a tried move without
+ * copying the list of captured stones.
+ *
+ * @param[in]   color   BLACK|WHITE
+ * @return      Number of stones put back
+ * @sa          remove_stones()
+ */
+int restore_stones( int color )
+{
+    int k;
+    int index_1d;
+    int count_restored = removed_max[color+1];
+
+    for ( k = 0; k < count_restored; k++ ) {
+        index_1d = removed[color+1][k];
+        update_pattern( index_1d, EMPTY, color );
+        update_eval_data( index_1d, EMPTY, color );
+        board[index_1d] = color;
+        hash_id ^= zobrist[ color + 1 ][index_1d];
+    }
+    removed_max[color+1] = 0;
+
+    if ( color == WHITE ) {
+        captured_by_black -= count_restored;
+    }
+    else {
+        captured_by_white -= count_restored;
+    }
+
+    return count_restored;
+}
+
 /**
  * @brief       Returns size of given worm.
  *
@@ -1307,6 +2300,136 @@ int get_size_of_worm( int worm_nr )
 
 
 
+/**
+ * @name    Position related functions
+ *
+ * Functions that identify or copy the whole position.
+ *
+ */
+
+//@{
+
+/**
+ * @brief       Fills the zobrist random numbers.
+ *
+ * Creates the random numbers for the zobrist hash ids. A fixed seed is used,
+ * so hash ids are the same in every program run. The numbers are only
+ * created once and then shared by all threads.
+ *
+ * @return      Nothing
+ * @note        The first call must happen before any search thread is started.
+ */
+void init_zobrist(void)
+{
+    int k;
+    hash_t x = 0x2545F4914F6CDD1DULL;
+
+    if ( is_zobrist_init ) {
+        return;
+    }
+
+    for ( k = 0; k < ( BOARD_SIZE_MAX + 1 ) * ( BOARD_SIZE_MAX + 2 ); k++ ) {
+        // xorshift64:
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        zobrist[BLACK_INDEX][k] = x;
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        zobrist[WHITE_INDEX][k] = x;
+        zobrist[EMPTY_INDEX][k] = 0;
+    }
+
+    is_zobrist_init = true;
+
+    return;
+}
+
+/**
+ * @brief       Returns hash id of current position.
+ *
+ * Returns the zobrist hash id of the stones on the board combined with the
+ * number of captured stones. The hash id is updated incrementally by every
+ * function that changes the board.
+ *
+ * @return      Hash id
+ * @note        The side to move is not part of the hash id.
+ */
+hash_t get_hash_id(void)
+{
+
+    return hash_id
+        ^ ( (hash_t)captured_by_black * 0xC2B2AE3D27D4EB4FULL )
+        ^ ( (hash_t)captured_by_white * 0x165667B19E3779F9ULL );
+}
+
+/**
+ * @brief       Copies the current position.
+ *
+ * Copies board size, stones and captured stones into the given snapshot, so
+ * the position can be set up on another thread's board.
+ *
+ * @param[out]  snapshot    Copy of the current position
+ * @return      Nothing
+ * @sa          set_board_snapshot()
+ */
+void get_board_snapshot( board_snapshot_t *snapshot )
+{
+    int i, j;
+
+    snapshot->board_size     = board_size;
+    snapshot->black_captured = captured_by_black;
+    snapshot->white_captured = captured_by_white;
+
+    for ( i = 0; i < board_size; i++ ) {
+        for ( j = 0; j < board_size; j++ ) {
+            snapshot->vertex[ i * BOARD_SIZE_MAX + j ] = board[ INDEX(i,j) ];
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief       Sets up a copied position.
+ *
+ * Sets up the position of the given snapshot on the board of the calling
+ * thread. If the board has not been allocated yet or has a different size,
+ * it is (re-)initialised first.
+ *
+ * @param[in]   snapshot    Position as created by get_board_snapshot()
+ * @return      Nothing
+ * @sa          get_board_snapshot()
+ */
+void set_board_snapshot( const board_snapshot_t *snapshot )
+{
+    int i, j;
+
+    if ( board == NULL || board_size != snapshot->board_size ) {
+        if ( board != NULL ) {
+            free_board();
+        }
+        init_board( snapshot->board_size );
+    }
+
+    for ( i = 0; i < board_size; i++ ) {
+        for ( j = 0; j < board_size; j++ ) {
+            set_vertex( snapshot->vertex[ i * BOARD_SIZE_MAX + j ], i, j );
+        }
+    }
+
+    captured_by_black = snapshot->black_captured;
+    captured_by_white = snapshot->white_captured;
+
+    scan_board_1();
+
+    return;
+}
+
+//@}
+
+
 /**
  * @name    Capture related functions
  *
@@ -13,9 +13,33 @@
  */
 
 #include <stdbool.h>
+#include "global_const.h"
+#include "hash.h"
 
 typedef unsigned short bsize_t;     //!< Type of board size value.
 
+/**
+ * @brief   Structure that stores a copy of a position.
+ *
+ **/
+typedef struct {
+    bsize_t board_size;                                 //!< Size of the board.
+    int     vertex[BOARD_SIZE_MAX * BOARD_SIZE_MAX];    //!< Color per vertex; index is i * BOARD_SIZE_MAX + j.
+    int     black_captured;                             //!< Number of white stones captured by black.
+    int     white_captured;                             //!< Number of black stones captured by white.
+} board_snapshot_t;
+
+/**
+ * @brief   Structure that sums up the worms of one color.
+ *
+ **/
+typedef struct {
+    int worms;          //!< Number of worms.
+    int liberties;      //!< Sum of the liberties of all worms.
+    int atari_worms;    //!< Number of worms with one liberty.
+    int atari_stones;   //!< Number of stones in worms with one liberty.
+} worm_stats_t;
+
 void init_board( bsize_t board_size );
 void free_board(void);
 
@@ -26,6 +50,7 @@ void get_board_as_string( char board_output[] );
 
 void set_vertex( int color, int i, int j );
 int  get_vertex( int i, int j );
+unsigned short get_pattern( int i, int j );
 
 void scan_board_1(void);
 void scan_board_1_upd( int i, int j );
@@ -40,6 +65,7 @@ void set_white_captured( int captured );
 void set_black_captured( int captured );
 
 int remove_stones( int color );
+int restore_stones( int color );
 
 int get_worm_liberty_count( int i, int j );
 
@@ -48,7 +74,20 @@ int get_worm_nr( int i, int j );
 int get_nr_of_liberties( int worm_nr );
 int get_captured_now( int captured[][2] );
 int get_stone_count( int color );
+void set_stone_weight( int term, int (*weight)( int i, int j ) );
+int  get_stone_term( int term );
+int  get_area_estimate(void);
+int  get_pass_alive( int i, int j );
+bool is_eye_vital_point( int color, int i, int j );
 int get_worm_count_atari( int color );
+void get_worm_stats( int color, worm_stats_t *stats );
+int get_worm_liberties( int color, int nr_of_liberties, int liberties[][3] );
+bool is_legal_move( int color, int i, int j );
+bool is_hoshi( int i, int j );
+
+hash_t get_hash_id(void);
+void   get_board_snapshot( board_snapshot_t *snapshot );
+void   set_board_snapshot( const board_snapshot_t *snapshot );
 
 #endif
 
@@ -28,7 +28,6 @@ typedef struct worm_st {
 
 bool is_board_null(void);
 bool is_on_board( int i, int j );
-bool is_hoshi( int i, int j );
 void init_hoshi(void);
 void set_hoshi( int i, int j );
 int  get_vertex_intern( int index_1d );
@@ -1,7 +1,12 @@
 #include <stdlib.h> // DEBUG
 #include <stdio.h>  // DEBUG
+#include <string.h>
+#include <limits.h>
 #include "global_const.h"
 #include "board.h"
+#include "hash.h"
+#include "influence.h"
+#include "network.h"
 #include "evaluate.h"
 
 /**
@@ -11,61 +16,191 @@
  *
  * Evaluates the board position.
  *
+ * Every brain computes one feature of the position. The features form a
+ * vector that is multiplied with the vector of factors (see hg-factors) in
+ * one vector operation; the products are limited and summed up. A brain
+ * with factor zero is not called at all.
+ *
+ * The brains are grouped into tiers of growing cost: terms kept by the board
+ * first, then brains that read the worm data, then brains that compute a map
+ * of the whole board. Every brain of the later tiers has a bound of its
+ * feature per vertex of the board. evaluate_position_window() stops after a
+ * tier if the value cannot enter the given window even with the largest
+ * possible contribution of the remaining tiers.
+ *
+ * evaluate_positions() evaluates a batch of positions given as snapshots.
+ * Every brain with a batch function computes its term for all positions in
+ * one loop over the batch. The other brains are called once per position
+ * after the snapshot has been set up on the board.
+ *
+ * Brains that only depend on single stones give a weight per vertex instead
+ * of a function. The board keeps their terms up to date with every stone
+ * that is set, captured or put back (see set_stone_weight()), so they cost
+ * nothing when a position is evaluated.
+ *
+ * evaluate_position() keeps the values of all brains of a position in a
+ * lossy cache shared by all threads. Like the transposition table (see
+ * hash.c) the cache has no locks: the check word of an entry is the hash id
+ * XORed with all data words, so a torn entry is treated as a miss.
+ *
  */
 
 
+//! Number of features in a feature vector, a power of 2 not below COUNT_BRAINS.
+#define FEATURE_COUNT   16
+
+#if FEATURE_COUNT < COUNT_BRAINS
+#error "FEATURE_COUNT must not be less than COUNT_BRAINS"
+#endif
+
+//! Number of positions given to a batch function at once.
+#define BATCH_SIZE  ( BOARD_SIZE_MAX * BOARD_SIZE_MAX )
+
+//! Value of limits[] for a brain without limit.
+#define NO_LIMIT    INT_MAX
+
+#define TIER_BOARD  0   //!< Tier of brains whose terms are kept by the board.
+#define TIER_WORMS  1   //!< Tier of brains that read the worm data.
+#define TIER_MAP    2   //!< Tier of brains that compute a map of the whole board.
+
+//! Vector with one value per brain; the entries above COUNT_BRAINS are zero.
+typedef int feature_vector_t __attribute__ (( vector_size( FEATURE_COUNT * sizeof(int) ) ));
+
 /**
- * @brief   Struct that combines brain function with its multiply factor.
+ * @brief   Struct that combines the functions of a brain.
  *
  **/
 typedef struct {
-    int (*function)();  //!< Pointer to brain function.
-    int factor;         //!< Multiply value to combine with brain function.
-    int limit;          //!< Sets a limit to the brain value.
+    int (*function)(void);  //!< Pointer to brain function.
+    int (*weight)( int i, int j );  //!< Pointer to weight function per vertex or NULL.
+    void (*batch_function)( const board_snapshot_t snapshots[], int count, int values[] );  //!< Pointer to brain function for a batch of positions or NULL.
+    int tier;               //!< Cost tier of the brain, see TIER_BOARD.
+    int bound;              //!< Largest absolute feature per vertex of the board (not used in TIER_BOARD).
 } brain_t;
 
 static brain_t brains[COUNT_BRAINS];    //!< List of all brain functions.
+static feature_vector_t factors;        //!< Multiply value per brain.
+static feature_vector_t limits;         //!< Limit of the multiplied value per brain or NO_LIMIT.
 
-int brain_capture(void);
+/**
+ * @brief   Structure that represents an evaluation cache entry.
+ *
+ **/
+typedef struct {
+    hash_t check;                               //!< Hash id XORed with all data words.
+    hash_t data[ ( COUNT_BRAINS + 1 ) / 2 ];    //!< Values of brains, two per word.
+} eval_slot_t;
+
+static eval_slot_t *eval_cache = NULL;          //!< Evaluation cache.
+
+static __thread unsigned long long int eval_probes;     //!< Number of lookups in evaluation cache.
+static __thread unsigned long long int eval_hits;       //!< Number of hits in evaluation cache.
+static __thread unsigned long long int eval_lazy;       //!< Number of evaluations with window.
+static __thread unsigned long long int eval_tier_skips[EVAL_TIERS]; //!< Number of evaluations that skipped a tier.
+static __thread int batch_terms[BATCH_SIZE];    //!< Terms of one brain for a part of a batch.
 
-// ----- Deactivated for now ------
+int brain_capture(void);
+int brain_bouzy(void);
+int brain_area(void);
+int brain_network(void);
 int brain_atari(void);
 int brain_avg_liberties(void);
-int brain_edge_stones(void);
-int brain_hoshi_stones(void);
-// --------------------------------
+void brain_capture_batch( const board_snapshot_t snapshots[], int count, int values[] );
+void brain_edge_stones_batch( const board_snapshot_t snapshots[], int count, int values[] );
+
+static void extract_features( feature_vector_t *features );
+static void extract_tier( int tier, feature_vector_t *features );
+static int sum_products( const feature_vector_t *features, int value_list[] );
+static int get_tier_margin( int tier );
+static int limit_value( int k, int value );
+static hash_t get_eval_key(void);
+static bool probe_eval_cache( hash_t key, int value_list[] );
+static void store_eval_cache( hash_t key, const int value_list[] );
+static int get_brain_value( int k );
+static int weight_edge_stones( int i, int j );
+static int weight_hoshi_stones( int i, int j );
 
 /**
  * @brief       Initialises brains data structure.
  *
- * Creates an array of brain_t structs, which combines brain functions with a
- * multiply factor.
+ * Creates an array of brain_t structs with the brain functions and sets the
+ * vectors of factors and limits. The weight functions are handed to the
+ * board.
  *
  * @return      Nothing
  */
 void init_brains(void)
 {
+    int k;
     int i = 0;
 
+    for ( k = 0; k < FEATURE_COUNT; k++ ) {
+        factors[k] = 0;
+        limits[k]  = NO_LIMIT;
+    }
+
     brains[i].function = (*brain_capture);
-    brains[i].factor   = 1;
-    brains[i++].limit  = 0;
+    brains[i].batch_function = (*brain_capture_batch);
+    brains[i].tier     = TIER_BOARD;
+    brains[i].bound    = 0;
+    factors[i]         = 1;
+    limits[i++]        = NO_LIMIT;
 
     brains[i].function = (*brain_atari);
-    brains[i].factor   = 0;
-    brains[i++].limit  = 0;
+    brains[i].tier     = TIER_WORMS;
+    brains[i].bound    = 1;
+    factors[i]         = 0;
+    limits[i++]        = NO_LIMIT;
 
     brains[i].function = (*brain_avg_liberties);
-    brains[i].factor   = 0;
-    brains[i++].limit  = 0;
+    brains[i].tier     = TIER_WORMS;
+    brains[i].bound    = 1;
+    factors[i]         = 0;
+    limits[i++]        = NO_LIMIT;
+
+    brains[i].weight   = (*weight_edge_stones);
+    brains[i].batch_function = (*brain_edge_stones_batch);
+    brains[i].tier     = TIER_BOARD;
+    brains[i].bound    = 0;
+    factors[i]         = 0;
+    limits[i++]        = NO_LIMIT;
+
+    brains[i].weight   = (*weight_hoshi_stones);
+    brains[i].tier     = TIER_BOARD;
+    brains[i].bound    = 0;
+    factors[i]         = 0;
+    limits[i++]        = NO_LIMIT;
+
+    brains[i].function = (*brain_bouzy);
+    brains[i].tier     = TIER_MAP;
+    brains[i].bound    = 1;
+    factors[i]         = 0;
+    limits[i++]        = NO_LIMIT;
+
+    brains[i].function = (*brain_area);
+    brains[i].tier     = TIER_MAP;
+    brains[i].bound    = 1;
+    factors[i]         = 0;
+    limits[i++]        = NO_LIMIT;
+
+    brains[i].function = (*brain_network);
+    brains[i].tier     = TIER_BOARD;
+    brains[i].bound    = 0;
+    factors[i]         = 0;
+    limits[i++]        = NO_LIMIT;
 
-    brains[i].function = (*brain_edge_stones);
-    brains[i].factor   = 0;
-    brains[i++].limit  = 0;
+    for ( k = 0; k < COUNT_BRAINS; k++ ) {
+        set_stone_weight( k, brains[k].weight );
+    }
 
-    brains[i].function = (*brain_hoshi_stones);
-    brains[i].factor   = 0;
-    brains[i++].limit  = 0;
+    if ( eval_cache == NULL ) {
+        eval_cache = malloc( EVAL_CACHE_SIZE * sizeof(eval_slot_t) );
+        if ( eval_cache == NULL ) {
+            fprintf( stderr, "cannot allocate memory for evaluation cache\n" );
+            exit(EXIT_FAILURE);
+        }
+    }
+    clear_eval_cache();
 
     return;
 }
@@ -80,7 +215,10 @@ void init_brains(void)
  */
 void set_factor( int index, int factor )
 {
-    brains[index].factor = factor;
+    factors[index] = factor;
+
+    // Cached values have been computed with the old factor:
+    clear_eval_cache();
 
     return;
 }
@@ -96,7 +234,7 @@ void set_factor( int index, int factor )
 int get_factor( int index )
 {
 
-    return brains[index].factor;
+    return factors[index];
 }
 
 /**
@@ -106,40 +244,483 @@ int get_factor( int index )
  * functions and returns a single value.
  *
  * @param[out]  value_list  List of different value parts (necessary for debugging).
- * @param[in]   do_full_eval    If true, does full evaluation.
  * @return      Value of position
- * @note        Full evaluation (with do_eval_full set to true) should not be
- *              done for move ordering, only at the end of the search tree.
- * @todo        Make sure that do_full_eval == false does not evaluate all
- *              functions!
+ * @note        Stone counts and terms with weight function are kept up to
+ *              date by the board, no board scan is needed here.
+ * @note        Values are taken from the evaluation cache if possible.
  */
-int evaluate_position( int value_list[], bool do_full_eval )
+int evaluate_position( int value_list[] )
 {
     int k;
-    int value = 0;
+    int value  = 0;
+    hash_t key = get_eval_key();
+    feature_vector_t features;
+
+    eval_probes++;
+    if ( probe_eval_cache( key, value_list ) ) {
+        eval_hits++;
+        for ( k = 0; k < COUNT_BRAINS; k++ ) {
+            value += value_list[k];
+        }
 
-    // TEST:
-    if ( do_full_eval ) {
-        scan_board_2();
+        return value;
+    }
+
+    extract_features(&features);
+    value = sum_products( &features, value_list );
+
+    store_eval_cache( key, value_list );
+
+    return value;
+}
+
+/**
+ * @brief       Evaluates a position for an alpha-beta window.
+ *
+ * The brains are evaluated tier by tier. If after a tier the value cannot
+ * enter the window from alpha to beta, even if the remaining tiers give
+ * their largest possible contribution, the remaining tiers are skipped.
+ * Then the bound of the value next to the window is returned and the values
+ * of the skipped brains in value_list are zero.
+ *
+ * @param[out]  value_list  List of different value parts (necessary for debugging).
+ * @param[in]   alpha       Alpha-Beta pruning
+ * @param[in]   beta        Alpha-Beta pruning
+ * @return      Value of position or bound outside of the window
+ * @note        Values are taken from the evaluation cache if possible, only
+ *              complete evaluations are stored.
+ * @sa          evaluate_position()
+ */
+int evaluate_position_window( int value_list[], int alpha, int beta )
+{
+    int k;
+    int tier;
+    int margin;
+    int value  = 0;
+    hash_t key = get_eval_key();
+    feature_vector_t features;
+
+    eval_probes++;
+    if ( probe_eval_cache( key, value_list ) ) {
+        eval_hits++;
+        for ( k = 0; k < COUNT_BRAINS; k++ ) {
+            value += value_list[k];
+        }
+
+        return value;
+    }
+
+    eval_lazy++;
+    features = factors & 0;
+    for ( tier = 0; tier < EVAL_TIERS; tier++ ) {
+        extract_tier( tier, &features );
+        if ( tier == EVAL_TIERS - 1 ) {
+            break;
+        }
+
+        value  = sum_products( &features, value_list );
+        margin = get_tier_margin(tier);
+        if ( value + margin < alpha ) {
+            eval_tier_skips[ tier + 1 ]++;
+            return value + margin;
+        }
+        if ( value - margin > beta ) {
+            eval_tier_skips[ tier + 1 ]++;
+            return value - margin;
+        }
+    }
+
+    value = sum_products( &features, value_list );
+    store_eval_cache( key, value_list );
+
+    return value;
+}
+
+/**
+ * @brief       Evaluates a batch of positions.
+ *
+ * Returns the same values as evaluate_position() for every given
+ * position. The position on the board is unchanged afterwards.
+ *
+ * @param[in]   snapshots   Positions as created by get_board_snapshot()
+ * @param[in]   count       Number of positions
+ * @param[out]  values      Value per position
+ * @return      Nothing
+ * @note        All positions must have the board size of the current board.
+ */
+void evaluate_positions( const board_snapshot_t snapshots[], int count, int values[] )
+{
+    int k;
+    int n;
+    int first;
+    int size;
+    bool needs_board = false;
+    board_snapshot_t current;
+
+    for ( n = 0; n < count; n++ ) {
+        values[n] = 0;
     }
 
     for ( k = 0; k < COUNT_BRAINS; k++ ) {
-        if ( brains[k].factor == 0 ) {
-            value_list[k] = 0;
+        if ( factors[k] == 0 ) {
             continue;
         }
+        if ( brains[k].batch_function == NULL ) {
+            needs_board = true;
+            continue;
+        }
+
+        for ( first = 0; first < count; first += BATCH_SIZE ) {
+            size = ( count - first < BATCH_SIZE ) ? count - first : BATCH_SIZE;
+            brains[k].batch_function( &snapshots[first], size, batch_terms );
+            for ( n = 0; n < size; n++ ) {
+                values[ first + n ] += limit_value( k, batch_terms[n] * factors[k] );
+            }
+        }
+    }
+
+    // Brains without batch function work on the board:
+    if ( needs_board ) {
+        get_board_snapshot(&current);
+        for ( n = 0; n < count; n++ ) {
+            set_board_snapshot( &snapshots[n] );
+            for ( k = 0; k < COUNT_BRAINS; k++ ) {
+                if ( factors[k] != 0 && brains[k].batch_function == NULL ) {
+                    values[n] += limit_value( k, get_brain_value(k) * factors[k] );
+                }
+            }
+        }
+        set_board_snapshot(&current);
+    }
+
+    return;
+}
+
+/**
+ * @brief       Checks if a batch of positions should be evaluated together.
+ *
+ * This is the case if all active brains have a batch function, so
+ * evaluate_positions() never has to set up a position on the board, and at
+ * least one of them reads the stones. Terms kept by the board (TIER_BOARD)
+ * cost nothing in evaluate_position(), copying the positions for them does
+ * not pay off.
+ *
+ * @return      true|false
+ * @sa          evaluate_positions()
+ */
+bool is_batch_evaluation(void)
+{
+    int k;
+    bool reads_stones = false;
+
+    for ( k = 0; k < COUNT_BRAINS; k++ ) {
+        if ( factors[k] == 0 ) {
+            continue;
+        }
+        if ( brains[k].batch_function == NULL ) {
+            return false;
+        }
+        if ( brains[k].tier != TIER_BOARD ) {
+            reads_stones = true;
+        }
+    }
+
+    return reads_stones;
+}
+
+/**
+ * @brief       Deletes all entries of the evaluation cache.
+ *
+ * @return      Nothing
+ * @note        Must not be called while a search is running.
+ */
+void clear_eval_cache(void)
+{
+    if ( eval_cache != NULL ) {
+        memset( eval_cache, 0, EVAL_CACHE_SIZE * sizeof(eval_slot_t) );
+    }
+
+    return;
+}
+
+/**
+ * @brief       Returns the statistics of the evaluation cache.
+ *
+ * The numbers are counted per thread since the last call of
+ * reset_eval_cache_stats() by the calling thread.
+ *
+ * @param[out]  probes  Number of lookups
+ * @param[out]  hits    Number of hits
+ * @return      Nothing
+ */
+void get_eval_cache_stats( unsigned long long int *probes, unsigned long long int *hits )
+{
+    *probes = eval_probes;
+    *hits   = eval_hits;
+
+    return;
+}
+
+/**
+ * @brief       Returns the statistics of evaluations with window.
+ *
+ * The numbers are counted per thread since the last call of
+ * reset_eval_cache_stats() by the calling thread. Tier 0 is never skipped,
+ * a skipped tier counts for all following tiers.
+ *
+ * @param[out]  lazy    Number of evaluations with window that missed the cache
+ * @param[out]  skips   Number of evaluations that stopped before tier, per tier
+ * @return      Nothing
+ * @sa          evaluate_position_window()
+ */
+void get_eval_tier_stats( unsigned long long int *lazy, unsigned long long int skips[] )
+{
+    int tier;
+
+    *lazy = eval_lazy;
+    for ( tier = 0; tier < EVAL_TIERS; tier++ ) {
+        skips[tier] = eval_tier_skips[tier];
+    }
+
+    return;
+}
+
+/**
+ * @brief       Resets the statistics of the evaluation cache.
+ *
+ * The statistics of evaluations with window are reset too.
+ *
+ * @return      Nothing
+ * @sa          get_eval_cache_stats(), get_eval_tier_stats()
+ */
+void reset_eval_cache_stats(void)
+{
+    int tier;
+
+    eval_probes = 0;
+    eval_hits   = 0;
+    eval_lazy   = 0;
+    for ( tier = 0; tier < EVAL_TIERS; tier++ ) {
+        eval_tier_skips[tier] = 0;
+    }
+
+    return;
+}
+
+/**
+ * @brief       Returns the key of the current position for the cache.
+ *
+ * The board hash id does not know the board size, the empty board has hash
+ * id zero on every size.
+ *
+ * @return      Key for evaluation cache
+ */
+hash_t get_eval_key(void)
+{
+
+    return get_hash_id() ^ ( (hash_t)get_board_size() * 0x9E3779B97F4A7C15ULL );
+}
+
+/**
+ * @brief       Looks up a position in the evaluation cache.
+ *
+ * @param[in]   key         Key of position
+ * @param[out]  value_list  Values of brains if found
+ * @return      true|false
+ * @sa          store_eval_cache()
+ */
+bool probe_eval_cache( hash_t key, int value_list[] )
+{
+    int k;
+    hash_t check;
+    hash_t data[ ( COUNT_BRAINS + 1 ) / 2 ];
+    eval_slot_t *slot;
+
+    if ( eval_cache == NULL ) {
+        return false;
+    }
+
+    slot  = &eval_cache[ key & ( EVAL_CACHE_SIZE - 1 ) ];
+    check = __atomic_load_n( &slot->check, __ATOMIC_RELAXED );
+    for ( k = 0; k < ( COUNT_BRAINS + 1 ) / 2; k++ ) {
+        data[k] = __atomic_load_n( &slot->data[k], __ATOMIC_RELAXED );
+        check  ^= data[k];
+    }
+
+    if ( check != key ) {
+        return false;
+    }
+
+    for ( k = 0; k < COUNT_BRAINS; k++ ) {
+        value_list[k] = (int)(unsigned int)( data[ k / 2 ] >> ( 32 * ( k % 2 ) ) );
+    }
+
+    return true;
+}
+
+/**
+ * @brief       Stores the values of a position in the evaluation cache.
+ *
+ * The entry at the slot of the given key is always replaced.
+ *
+ * @param[in]   key         Key of position
+ * @param[in]   value_list  Values of brains
+ * @return      Nothing
+ * @sa          probe_eval_cache()
+ */
+void store_eval_cache( hash_t key, const int value_list[] )
+{
+    int k;
+    hash_t check = key;
+    hash_t data[ ( COUNT_BRAINS + 1 ) / 2 ] = { 0 };
+    eval_slot_t *slot;
+
+    if ( eval_cache == NULL ) {
+        return;
+    }
+
+    for ( k = 0; k < COUNT_BRAINS; k++ ) {
+        data[ k / 2 ] |= (hash_t)(unsigned int)value_list[k] << ( 32 * ( k % 2 ) );
+    }
+
+    slot = &eval_cache[ key & ( EVAL_CACHE_SIZE - 1 ) ];
+    for ( k = 0; k < ( COUNT_BRAINS + 1 ) / 2; k++ ) {
+        check ^= data[k];
+        __atomic_store_n( &slot->data[k], data[k], __ATOMIC_RELAXED );
+    }
+    __atomic_store_n( &slot->check, check, __ATOMIC_RELAXED );
+
+    return;
+}
+
+/**
+ * @brief       Fills the feature vector of the current position.
+ *
+ * Every brain with a factor computes its feature, the other features are
+ * zero.
+ *
+ * @param[out]  features    Feature per brain
+ * @return      Nothing
+ */
+void extract_features( feature_vector_t *features )
+{
+    int tier;
+
+    *features = factors & 0;
+    for ( tier = 0; tier < EVAL_TIERS; tier++ ) {
+        extract_tier( tier, features );
+    }
+
+    return;
+}
+
+/**
+ * @brief       Fills the features of one tier of the current position.
+ *
+ * @param[in]   tier        Tier of brains
+ * @param[out]  features    Feature per brain, only the given tier is set
+ * @return      Nothing
+ */
+void extract_tier( int tier, feature_vector_t *features )
+{
+    int k;
+
+    for ( k = 0; k < COUNT_BRAINS; k++ ) {
+        if ( brains[k].tier == tier && factors[k] != 0 ) {
+            (*features)[k] = get_brain_value(k);
+        }
+    }
+
+    return;
+}
 
-        value_list[k] = brains[k].function() * brains[k].factor;
+/**
+ * @brief       Multiplies the features with the factors and sums up.
+ *
+ * The dot product is done as one vector operation, every product is
+ * limited without branches.
+ *
+ * @param[in]   features    Feature per brain
+ * @param[out]  value_list  Limited product per brain
+ * @return      Sum of the limited products
+ */
+int sum_products( const feature_vector_t *features, int value_list[] )
+{
+    int k;
+    int value = 0;
+    feature_vector_t products;
+
+    // Comparisons give -1 for true:
+    products = *features * factors;
+    products = ( products & ( products <= limits ) ) | ( limits & ( products > limits ) );
+    products = ( products & ( products >= -limits ) ) | ( -limits & ( products < -limits ) );
 
-        // Limit value:
-        if ( brains[k].limit && value_list[k] > 0 && value_list[k] > brains[k].limit ) {
-            value_list[k] = brains[k].limit;
+    for ( k = 0; k < COUNT_BRAINS; k++ ) {
+        value_list[k] = products[k];
+        value        += products[k];
+    }
+
+    return value;
+}
+
+/**
+ * @brief       Returns the largest contribution of the tiers after a tier.
+ *
+ * @param[in]   tier    Last evaluated tier
+ * @return      Largest absolute sum of the brains of the following tiers
+ */
+int get_tier_margin( int tier )
+{
+    int k;
+    int contribution;
+    int margin = 0;
+    int area   = get_board_size() * get_board_size();
+
+    for ( k = 0; k < COUNT_BRAINS; k++ ) {
+        if ( brains[k].tier <= tier || factors[k] == 0 ) {
+            continue;
         }
-        else if ( brains[k].limit && value_list[k] < 0 && value_list[k] < brains[k].limit * -1 ) {
-            value_list[k] = brains[k].limit * -1;
+        contribution = abs( factors[k] ) * brains[k].bound * area;
+        if ( contribution > limits[k] ) {
+            contribution = limits[k];
         }
+        margin += contribution;
+    }
+
+    return margin;
+}
 
-        value += value_list[k];
+/**
+ * @brief       Returns the value of a brain for the current position.
+ *
+ * @param[in]   k       Index of brain in brains array.
+ * @return      Term kept by the board or value of brain function
+ */
+int get_brain_value( int k )
+{
+
+    if ( brains[k].weight != NULL ) {
+        return get_stone_term(k);
+    }
+
+    return brains[k].function();
+}
+
+/**
+ * @brief       Limits the value of a brain.
+ *
+ * @param[in]   k       Index of brain in brains array.
+ * @param[in]   value   Value of brain multiplied with its factor.
+ * @return      Value within the limit of the brain
+ */
+int limit_value( int k, int value )
+{
+
+    if ( value > limits[k] ) {
+        value = limits[k];
+    }
+    else if ( value < -limits[k] ) {
+        value = -limits[k];
     }
 
     return value;
@@ -161,94 +742,165 @@ int brain_capture(void)
 }
 
 
+/**
+ * @brief       Determines value of captured stones for a batch of positions.
+ *
+ * @param[in]   snapshots   Positions
+ * @param[in]   count       Number of positions
+ * @param[out]  values      Value per position
+ * @return      Nothing
+ * @sa          brain_capture()
+ */
+void brain_capture_batch( const board_snapshot_t snapshots[], int count, int values[] )
+{
+    int n;
+
+    for ( n = 0; n < count; n++ ) {
+        values[n] = snapshots[n].black_captured - snapshots[n].white_captured;
+    }
+
+    return;
+}
+
 /**
  * @brief       Determines value depending on atari.
  *
  * The returned value is determined by the number and size of groups being in
- * atari.
+ * atari: the white stones in atari minus the black stones in atari.
  *
  * @return      Value of position
+ * @note        The worm data of the board must be up to date.
+ * @sa          get_worm_stats()
  */
 int brain_atari(void)
 {
-    //int k;
-    int value             = 0;
-    //int count_atari_white = 0;
-    //int count_atari_black = 0;
-
-    /*
-    int last_white_group = get_last_group_nr(WHITE) * -1;
-    int last_black_group = get_last_group_nr(BLACK);
-    
-    for ( k = 0; k <= last_white_group; k++ ) {
-        if ( get_nr_of_liberties( k * -1 ) == 1 ) {
-            count_atari_white += get_size_of_worm( k * -1 );
-        }
+    worm_stats_t black;
+    worm_stats_t white;
+
+    get_worm_stats( BLACK, &black );
+    get_worm_stats( WHITE, &white );
+
+    return white.atari_stones - black.atari_stones;
+}
+
+/**
+ * @brief       Weight of a stone on the edge.
+ *
+ * Every stone on the edge of the board costs one point, a stone in the
+ * corner counts for both edges.
+ *
+ * @param[in]   i   Horizontal coordinate
+ * @param[in]   j   Vertical coordinate
+ * @return      Weight of vertex
+ */
+int weight_edge_stones( int i, int j )
+{
+    int weight = 0;
+    int last   = get_board_size() - 1;
+
+    if ( i == 0 || i == last ) {
+        weight--;
+    }
+    if ( j == 0 || j == last ) {
+        weight--;
+    }
+
+    return weight;
+}
+
+/**
+ * @brief       Counts stones on edge for a batch of positions.
+ *
+ * @param[in]   snapshots   Positions
+ * @param[in]   count       Number of positions
+ * @param[out]  values      Value per position
+ * @return      Nothing
+ * @sa          weight_edge_stones()
+ */
+void brain_edge_stones_batch( const board_snapshot_t snapshots[], int count, int values[] )
+{
+    int k;
+    int n;
+    int last = get_board_size() - 1;
+
+    for ( n = 0; n < count; n++ ) {
+        values[n] = 0;
     }
 
-    for ( k = 0; k <= last_black_group; k++ ) {
-        if ( get_nr_of_liberties(k) == 1 ) {
-            count_atari_black += get_size_of_worm(k);
+    // Vertex index is i * BOARD_SIZE_MAX + j:
+    for ( k = 0; k <= last; k++ ) {
+        for ( n = 0; n < count; n++ ) {
+            values[n] -= snapshots[n].vertex[ k * BOARD_SIZE_MAX ]
+                       + snapshots[n].vertex[ k * BOARD_SIZE_MAX + last ]
+                       + snapshots[n].vertex[ k ]
+                       + snapshots[n].vertex[ last * BOARD_SIZE_MAX + k ];
         }
     }
 
-    value = count_atari_white - count_atari_black;
-    */
+    return;
+}
 
-    return value;
+/**
+ * @brief       Weight of a stone on a star point.
+ *
+ * Stones on star points get extra value. The term is kept by the board like
+ * the edge stones.
+ *
+ * @param[in]   i   Horizontal coordinate
+ * @param[in]   j   Vertical coordinate
+ * @return      Weight of vertex
+ * @todo        This should probably be only done in the opening phase.
+ */
+int weight_hoshi_stones( int i, int j )
+{
+
+    return is_hoshi( i, j ) ? 1 : 0;
 }
 
 /**
- * @brief       Counts stones on edge.
+ * @brief       Determines value of territory by influence.
  *
- * The returned value is determined by the number of stones on the edge of the
- * board.
+ * The influence map after Bouzy 5/21 is computed, the vertices controlled
+ * by black minus the vertices controlled by white is the returned value.
  *
  * @return      Value of position
+ * @sa          influence.c
  */
-int brain_edge_stones(void)
+int brain_bouzy(void)
 {
-    int i, j;
-    int value       = 0;
-    int board_size  = get_board_size();
-
-    for ( i = 0; i < board_size; i++ ) {
-        value += get_vertex( i, 0 );
-        value += get_vertex( i, board_size - 1 );
-    }
-    for ( j = 0; j < board_size; j++ ) {
-        value += get_vertex( 0, j );
-        value += get_vertex( board_size - 1, j );
-    }
+    compute_influence();
 
-    return value * -1;
+    return get_influence_territory();
 }
 
 /**
- * @brief       Evaluates stones on star points
+ * @brief       Determines value of estimated area.
  *
- * Stones on star points get extra value.
+ * Stones and empty regions surrounded by one color count for this color,
+ * see get_area_estimate().
  *
  * @return      Value of position
- * @todo        This should probably be only done in the opening phase.
+ * @note        The worm data of the board must be up to date.
  */
-int brain_hoshi_stones(void)
+int brain_area(void)
 {
-    //int i, j;
-    int value      = 0;
-    /*
-    int board_size = get_board_size();
-
-    for ( i = 0; i < board_size; i ++ ) {
-        for ( j = 0; j < board_size; j++ ) {
-            if ( is_hoshi( i, j ) ) {
-                value += get_vertex( i, j );
-            }
-        }
-    }
-    */
 
-    return value;
+    return get_area_estimate();
+}
+
+/**
+ * @brief       Determines value by the neural network.
+ *
+ * The first layer is kept up to date by the board, so only the output layer
+ * is computed.
+ *
+ * @return      Value of position, zero if no network is loaded
+ * @sa          network.c
+ */
+int brain_network(void)
+{
+
+    return get_network_value();
 }
 
 /**
@@ -259,46 +911,26 @@ int brain_hoshi_stones(void)
  * value.
  *
  * @return      Black average minus white average.
+ * @note        The worm data of the board must be up to date.
+ * @sa          get_worm_stats()
  */
 int brain_avg_liberties(void)
 {
-    int value;
-    /*
-    int value_black;
-    int value_white;
-    int count_groups_black;
-    int count_groups_white;
-    int count_liberties_black;
-    int count_liberties_white;
+    int value_black = 0;
+    int value_white = 0;
+    worm_stats_t black;
+    worm_stats_t white;
 
-    count_groups_black = get_last_group_nr(BLACK);
-    count_groups_white = get_last_group_nr(WHITE) * -1;
-    count_liberties_black = get_group_count_liberties(BLACK);
-    count_liberties_white = get_group_count_liberties(WHITE);
+    get_worm_stats( BLACK, &black );
+    get_worm_stats( WHITE, &white );
 
-    if ( count_groups_black == 0 ) {
-        count_groups_black = 1;
+    if ( black.worms > 0 ) {
+        value_black = black.liberties / black.worms;
     }
-    if ( count_groups_white == 0 ) {
-        count_groups_white = 1;
+    if ( white.worms > 0 ) {
+        value_white = white.liberties / white.worms;
     }
 
-    value_black = count_liberties_black / count_groups_black;
-    value_white = count_liberties_white / count_groups_white;
-    */
-
-    /*
-    if ( value_black > 4 ) {
-        value_black = 4;
-    }
-    if ( value_white > 4 ) {
-        value_white = 4;
-    }
-    */
-
-    //value = value_black - value_white;
-    value = 0;
-
-    return value;
+    return value_black - value_white;
 }
 
@@ -9,10 +9,19 @@
  */
 
 #include <stdbool.h>
+#include "board.h"
 
 void init_brains(void);
 void set_factor( int index, int factor );
 int  get_factor( int index );
-int  evaluate_position( int value_list[], bool do_full_eval );
+int  evaluate_position( int value_list[] );
+int  evaluate_position_window( int value_list[], int alpha, int beta );
+void evaluate_positions( const board_snapshot_t snapshots[], int count, int values[] );
+bool is_batch_evaluation(void);
+
+void clear_eval_cache(void);
+void get_eval_cache_stats( unsigned long long int *probes, unsigned long long int *hits );
+void get_eval_tier_stats( unsigned long long int *lazy, unsigned long long int skips[] );
+void reset_eval_cache_stats(void);
 
 #endif
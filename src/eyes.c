@@ -0,0 +1,129 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "global_const.h"
+#include "eyes.h"
+
+#ifndef EYE_GENERATOR
+#include "eye_table.h"
+#endif
+
+
+/**
+ * @file    eyes.c
+ *
+ * @brief   Table of small eye shapes.
+ *
+ * An eye shape is a connected set of up to EYE_SIZE_MAX empty points
+ * enclosed by stones of one color. Its key is a bit mask of the points in
+ * an 8x8 grid (bit y * 8 + x), moved to the upper left corner. The
+ * canonical key is the smallest key of all eight rotations and mirror
+ * images, so all symmetric shapes have the same key.
+ *
+ * The table eye_table[] is sorted by key and generated at build time by
+ * gen_eyes.c, which reads out every shape on a small board. It is
+ * compiled into this file from eye_table.h. The generator itself is built
+ * from this file with EYE_GENERATOR defined and only uses get_eye_key().
+ *
+ */
+
+#ifndef EYE_GENERATOR
+static int compare_eye_key( const void *key, const void *shape );
+#endif
+
+
+/**
+ * @brief       Computes the canonical key of a shape.
+ *
+ * @param[in]   count       Number of points, at most EYE_SIZE_MAX
+ * @param[in]   cells       Coordinates of points
+ * @param[out]  canonical   Canonical coordinates of every point or NULL
+ * @return      Canonical key
+ */
+uint64_t get_eye_key( int count, const int cells[][2], int canonical[][2] )
+{
+    int k;
+    int transform;
+    int x[EYE_SIZE_MAX];
+    int y[EYE_SIZE_MAX];
+    int swap;
+    int min_x, min_y;
+    uint64_t key;
+    uint64_t best_key = UINT64_MAX;
+
+    // Bit 0 swaps the axes, bit 1 and 2 mirror them:
+    for ( transform = 0; transform < 8; transform++ ) {
+        min_x = min_y = BOARD_SIZE_MAX;
+        for ( k = 0; k < count; k++ ) {
+            x[k] = cells[k][0];
+            y[k] = cells[k][1];
+            if ( transform & 1 ) {
+                swap = x[k];
+                x[k] = y[k];
+                y[k] = swap;
+            }
+            if ( transform & 2 ) {
+                x[k] = -x[k];
+            }
+            if ( transform & 4 ) {
+                y[k] = -y[k];
+            }
+            if ( x[k] < min_x ) {
+                min_x = x[k];
+            }
+            if ( y[k] < min_y ) {
+                min_y = y[k];
+            }
+        }
+
+        key = 0;
+        for ( k = 0; k < count; k++ ) {
+            x[k] -= min_x;
+            y[k] -= min_y;
+            key  |= (uint64_t)1 << ( y[k] * 8 + x[k] );
+        }
+
+        if ( key < best_key ) {
+            best_key = key;
+            for ( k = 0; canonical != NULL && k < count; k++ ) {
+                canonical[k][0] = x[k];
+                canonical[k][1] = y[k];
+            }
+        }
+    }
+
+    return best_key;
+}
+
+#ifndef EYE_GENERATOR
+
+/**
+ * @brief       Looks up an eye shape.
+ *
+ * @param[in]   key     Canonical key of shape
+ * @return      Status of shape or NULL if not in table
+ * @sa          get_eye_key()
+ */
+const eye_shape_t *get_eye_shape( uint64_t key )
+{
+
+    return bsearch( &key, eye_table, EYE_TABLE_SIZE, sizeof(eye_shape_t), compare_eye_key );
+}
+
+/**
+ * @brief       Compares a key with the key of an eye shape.
+ *
+ * Compare function for bsearch().
+ *
+ * @param[in]   key     Pointer to key
+ * @param[in]   shape   Pointer to eye shape
+ * @return      Negative, zero or positive value
+ */
+int compare_eye_key( const void *key, const void *shape )
+{
+    uint64_t k1 = *(const uint64_t *)key;
+    uint64_t k2 = ( (const eye_shape_t *)shape )->key;
+
+    return ( k1 > k2 ) - ( k1 < k2 );
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef EYES_H
+#define EYES_H
+
+/**
+ * @file    eyes.h
+ *
+ * @brief   Interface definition for eyes.c
+ *
+ */
+
+#include <stdint.h>
+
+#define EYE_SIZE_MAX    7   //!< Maximum number of points of an eye shape in the table.
+
+#define EYE_DEAD        0   //!< Eye space gives one eye at most, even if the owner moves first.
+#define EYE_UNSETTLED   1   //!< Eye space gives two eyes if the owner moves first.
+#define EYE_ALIVE       2   //!< Eye space gives two eyes even if the opponent moves first.
+
+//! Vital point of a shape without vital point.
+#define EYE_NO_VITAL    -1
+
+/**
+ * @brief   Status of an eye shape.
+ *
+ * The shape is given by its canonical key, see get_eye_key(). Vital points
+ * are coded as y * 8 + x in canonical coordinates. If a point kills when
+ * the opponent takes it and lives when the owner takes it, it is the vital
+ * point for both.
+ *
+ **/
+typedef struct {
+    uint64_t    key;            //!< Canonical key of shape.
+    signed char status;         //!< EYE_DEAD|EYE_UNSETTLED|EYE_ALIVE
+    signed char attack_vital;   //!< Move of the opponent that kills, or EYE_NO_VITAL.
+    signed char defend_vital;   //!< Move of the owner that lives, or EYE_NO_VITAL.
+} eye_shape_t;
+
+uint64_t get_eye_key( int count, const int cells[][2], int canonical[][2] );
+const eye_shape_t *get_eye_shape( uint64_t key );
+
+#endif
+
@@ -0,0 +1,529 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "global_const.h"
+#include "eyes.h"
+
+
+/**
+ * @file    gen_eyes.c
+ *
+ * @brief   Generates the table of eye shapes.
+ *
+ * Builds every shape of up to EYE_SIZE_MAX connected points and reads out
+ * its status. The shape is empty and enclosed by a black wall that has
+ * OUTSIDE_LIBERTIES liberties outside of the shape. White moves first in
+ * one reading and black in the other; white kills if it captures the wall.
+ * Black lives if the game ends with two passes. The program writes the
+ * table as C source to stdout, see eyes.c.
+ *
+ * Repeated positions (ko) are read as a win for black, the same position
+ * is not read again in one line. Results that depend on such a repetition
+ * are not kept, because they depend on the line.
+ *
+ */
+
+//! Number of liberties of the wall outside of the shape.
+#define OUTSIDE_LIBERTIES   2
+
+//! Maximum number of shapes of all sizes.
+#define MAX_SHAPES          256
+
+//! Number of positions of the shape with ko, passes and side to move.
+#define STATE_COUNT     ( 2187 * ( OUTSIDE_LIBERTIES + 1 ) * ( EYE_SIZE_MAX + 1 ) * 2 * 2 )
+
+//! Start of a flood fill from the wall instead of a point.
+#define WALL    -1
+
+#define MOVE_ILLEGAL        0   //!< Move is not legal.
+#define MOVE_OK             1   //!< Move has been made.
+#define MOVE_WALL_CAPTURED  2   //!< Move captures the wall.
+
+#define MEMO_OPEN           1   //!< Position is read in the current line.
+#define MEMO_WHITE_WINS     2   //!< White captures the wall.
+#define MEMO_BLACK_WINS     3   //!< Black keeps the wall.
+
+/**
+ * @brief   Position inside of a shape.
+ *
+ **/
+typedef struct {
+    int cell[EYE_SIZE_MAX];     //!< Color per point.
+    int outside;                //!< Outside liberties of the wall.
+    int ko;                     //!< Point that must not be retaken or INVALID.
+    int passed;                 //!< 1 if the last move was a pass.
+} position_t;
+
+static int  count_cells;                        //!< Number of points of the shape.
+static int  neighbours[EYE_SIZE_MAX][4];        //!< Neighbour points per point.
+static int  count_neighbours[EYE_SIZE_MAX];     //!< Number of neighbour points per point.
+static bool at_wall[EYE_SIZE_MAX];              //!< Point is next to the wall.
+static unsigned char memo[STATE_COUNT];         //!< Result per position.
+static bool is_repeated;                        //!< A repeated position has been read.
+
+static void set_shape( uint64_t key );
+static void print_shape( uint64_t key );
+static int  get_liberties( const position_t *pos, int start, bool member[] );
+static int  play( const position_t *pos, int color, int point, position_t *next );
+static bool is_white_win( const position_t *pos, int color );
+static int  get_state( const position_t *pos, int color );
+static int  compare_key( const void *key1, const void *key2 );
+
+
+/**
+ * @brief       Writes the table of eye shapes to stdout.
+ *
+ * @return      EXIT_SUCCESS
+ */
+int main(void)
+{
+    int k, l;
+    int n;
+    int m;
+    int count_shapes = 1;
+    int first        = 0;
+    int last;
+    int size;
+    int cells[EYE_SIZE_MAX][2];
+    int count;
+    uint64_t key;
+    uint64_t shapes[MAX_SHAPES];
+    const int offset[4][2] = { { 0, 1 }, { 1, 0 }, { 0, -1 }, { -1, 0 } };
+
+    // Every shape of size + 1 is a shape of size with one more point:
+    shapes[0] = 1;
+    for ( size = 1; size < EYE_SIZE_MAX; size++ ) {
+        last = count_shapes;
+        for ( k = first; k < last; k++ ) {
+            count = 0;
+            for ( l = 0; l < 64; l++ ) {
+                if ( shapes[k] & ( (uint64_t)1 << l ) ) {
+                    cells[count][0] = l % 8;
+                    cells[count][1] = l / 8;
+                    count++;
+                }
+            }
+            for ( l = 0; l < count; l++ ) {
+                for ( n = 0; n < 4; n++ ) {
+                    cells[count][0] = cells[l][0] + offset[n][0];
+                    cells[count][1] = cells[l][1] + offset[n][1];
+                    for ( m = 0; m < count; m++ ) {
+                        if ( cells[m][0] == cells[count][0] && cells[m][1] == cells[count][1] ) {
+                            break;
+                        }
+                    }
+                    if ( m < count ) {
+                        continue;
+                    }
+                    key = get_eye_key( count + 1, (const int (*)[2])cells, NULL );
+                    for ( m = last; m < count_shapes; m++ ) {
+                        if ( shapes[m] == key ) {
+                            break;
+                        }
+                    }
+                    if ( m == count_shapes ) {
+                        if ( count_shapes == MAX_SHAPES ) {
+                            fprintf( stderr, "Eye shapes have exceeded MAX_SHAPES\n" );
+                            exit(EXIT_FAILURE);
+                        }
+                        shapes[ count_shapes++ ] = key;
+                    }
+                }
+            }
+        }
+        first = last;
+    }
+
+    qsort( shapes, (size_t)count_shapes, sizeof(uint64_t), compare_key );
+
+    printf( "// Generated by gen_eyes, do not edit.\n\n" );
+    printf( "//! Number of shapes in eye_table[].\n" );
+    printf( "#define EYE_TABLE_SIZE  %d\n\n", count_shapes );
+    printf( "//! Status of every eye shape, sorted by key.\n" );
+    printf( "static const eye_shape_t eye_table[EYE_TABLE_SIZE] = {\n" );
+    for ( k = 0; k < count_shapes; k++ ) {
+        print_shape( shapes[k] );
+    }
+    printf( "};\n" );
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief       Sets the points and neighbours of a shape.
+ *
+ * The points are numbered in the order of the bits of the key.
+ *
+ * @param[in]   key     Canonical key of shape
+ * @return      Nothing
+ */
+void set_shape( uint64_t key )
+{
+    int k, l;
+    int x[EYE_SIZE_MAX];
+    int y[EYE_SIZE_MAX];
+
+    count_cells = 0;
+    for ( k = 0; k < 64; k++ ) {
+        if ( key & ( (uint64_t)1 << k ) ) {
+            x[count_cells] = k % 8;
+            y[count_cells] = k / 8;
+            count_cells++;
+        }
+    }
+
+    for ( k = 0; k < count_cells; k++ ) {
+        count_neighbours[k] = 0;
+        for ( l = 0; l < count_cells; l++ ) {
+            if ( abs( x[k] - x[l] ) + abs( y[k] - y[l] ) == 1 ) {
+                neighbours[k][ count_neighbours[k]++ ] = l;
+            }
+        }
+        at_wall[k] = count_neighbours[k] < 4;
+    }
+
+    return;
+}
+
+/**
+ * @brief       Reads out a shape and prints its table entry.
+ *
+ * @param[in]   key     Canonical key of shape
+ * @return      Nothing
+ */
+void print_shape( uint64_t key )
+{
+    int k;
+    int point;
+    int status;
+    int attack_vital = EYE_NO_VITAL;
+    int defend_vital = EYE_NO_VITAL;
+    int vital        = EYE_NO_VITAL;
+    bool is_kill;
+    bool is_live;
+    int bits[EYE_SIZE_MAX];
+    position_t start;
+    position_t next;
+    const char *name[3] = { "EYE_DEAD", "EYE_UNSETTLED", "EYE_ALIVE" };
+
+    set_shape(key);
+    memset( memo, 0, sizeof(memo) );
+
+    for ( k = 0; k < EYE_SIZE_MAX; k++ ) {
+        start.cell[k] = EMPTY;
+    }
+    start.outside = OUTSIDE_LIBERTIES;
+    start.ko      = INVALID;
+    start.passed  = 0;
+
+    if ( ! is_white_win( &start, WHITE ) ) {
+        status = EYE_ALIVE;
+    }
+    else if ( is_white_win( &start, BLACK ) ) {
+        status = EYE_DEAD;
+    }
+    else {
+        status = EYE_UNSETTLED;
+
+        // The vital point kills if white takes it and lives if black takes
+        // it. Shapes without such a point get the first points in key order
+        // that kill or live:
+        for ( point = 0; point < count_cells; point++ ) {
+            k = play( &start, WHITE, point, &next );
+            is_kill = ( k == MOVE_WALL_CAPTURED || ( k == MOVE_OK && is_white_win( &next, BLACK ) ) );
+            is_live = ( play( &start, BLACK, point, &next ) == MOVE_OK && ! is_white_win( &next, WHITE ) );
+            if ( is_kill && is_live && vital == EYE_NO_VITAL ) {
+                vital = point;
+            }
+            if ( is_kill && attack_vital == EYE_NO_VITAL ) {
+                attack_vital = point;
+            }
+            if ( is_live && defend_vital == EYE_NO_VITAL ) {
+                defend_vital = point;
+            }
+        }
+        if ( vital != EYE_NO_VITAL ) {
+            attack_vital = vital;
+            defend_vital = vital;
+        }
+
+        // Point number to canonical coordinates:
+        for ( k = 0, point = 0; k < 64; k++ ) {
+            if ( key & ( (uint64_t)1 << k ) ) {
+                bits[ point++ ] = k;
+            }
+        }
+        attack_vital = ( attack_vital == EYE_NO_VITAL ) ? EYE_NO_VITAL : bits[attack_vital];
+        defend_vital = ( defend_vital == EYE_NO_VITAL ) ? EYE_NO_VITAL : bits[defend_vital];
+    }
+
+    printf( "    { UINT64_C(0x%016" PRIx64 "), %-13s, %2d, %2d },    // size %d\n"
+        , key, name[status], attack_vital, defend_vital, count_cells );
+
+    return;
+}
+
+/**
+ * @brief       Counts the liberties of a group.
+ *
+ * Black stones next to the wall belong to the wall. The wall has its
+ * outside liberties and all empty points next to it.
+ *
+ * @param[in]   pos     Position
+ * @param[in]   start   Point of the group or WALL
+ * @param[out]  member  Points of the group
+ * @return      Number of liberties
+ */
+int get_liberties( const position_t *pos, int start, bool member[] )
+{
+    int k;
+    int n;
+    int color        = ( start == WALL ) ? BLACK : pos->cell[start];
+    int count        = 0;
+    int liberties    = 0;
+    bool is_wall     = false;
+    bool is_liberty[EYE_SIZE_MAX] = { false };
+    int stack[EYE_SIZE_MAX];
+
+    memset( member, 0, EYE_SIZE_MAX * sizeof(bool) );
+
+    if ( start == WALL ) {
+        is_wall = true;
+        for ( n = 0; n < count_cells; n++ ) {
+            if ( pos->cell[n] == BLACK && at_wall[n] ) {
+                member[n]        = true;
+                stack[ count++ ] = n;
+            }
+        }
+    }
+    else {
+        member[start]    = true;
+        stack[ count++ ] = start;
+    }
+
+    for ( k = 0; k < count; k++ ) {
+        // A black group next to the wall takes all black stones next to it:
+        if ( color == BLACK && at_wall[ stack[k] ] && ! is_wall ) {
+            is_wall = true;
+            for ( n = 0; n < count_cells; n++ ) {
+                if ( pos->cell[n] == BLACK && at_wall[n] && ! member[n] ) {
+                    member[n]        = true;
+                    stack[ count++ ] = n;
+                }
+            }
+        }
+        for ( n = 0; n < count_neighbours[ stack[k] ]; n++ ) {
+            if ( pos->cell[ neighbours[ stack[k] ][n] ] == color && ! member[ neighbours[ stack[k] ][n] ] ) {
+                member[ neighbours[ stack[k] ][n] ] = true;
+                stack[ count++ ] = neighbours[ stack[k] ][n];
+            }
+        }
+    }
+
+    for ( k = 0; k < count_cells; k++ ) {
+        if ( pos->cell[k] != EMPTY ) {
+            continue;
+        }
+        if ( is_wall && at_wall[k] ) {
+            is_liberty[k] = true;
+        }
+        for ( n = 0; n < count_neighbours[k]; n++ ) {
+            if ( member[ neighbours[k][n] ] ) {
+                is_liberty[k] = true;
+            }
+        }
+        liberties += is_liberty[k];
+    }
+
+    if ( is_wall ) {
+        liberties += pos->outside;
+    }
+
+    return liberties;
+}
+
+/**
+ * @brief       Makes a move.
+ *
+ * A point of INVALID is a white move outside, which takes an outside
+ * liberty of the wall.
+ *
+ * @param[in]   pos     Position before the move
+ * @param[in]   color   Color to move
+ * @param[in]   point   Point of move or INVALID
+ * @param[out]  next    Position after the move
+ * @return      MOVE_ILLEGAL|MOVE_OK|MOVE_WALL_CAPTURED
+ */
+int play( const position_t *pos, int color, int point, position_t *next )
+{
+    int k;
+    int n;
+    int captured      = 0;
+    int captured_point = INVALID;
+    int liberties;
+    bool member[EYE_SIZE_MAX];
+
+    *next        = *pos;
+    next->ko     = INVALID;
+    next->passed = 0;
+
+    if ( point == INVALID ) {
+        next->outside--;
+
+        return ( get_liberties( next, WALL, member ) == 0 ) ? MOVE_WALL_CAPTURED : MOVE_OK;
+    }
+
+    next->cell[point] = color;
+
+    for ( n = 0; n < count_neighbours[point]; n++ ) {
+        if ( next->cell[ neighbours[point][n] ] != color * -1 ) {
+            continue;
+        }
+        if ( get_liberties( next, neighbours[point][n], member ) > 0 ) {
+            continue;
+        }
+        for ( k = 0; color == WHITE && k < count_cells; k++ ) {
+            if ( member[k] && at_wall[k] ) {
+                return MOVE_WALL_CAPTURED;
+            }
+        }
+        for ( k = 0; k < count_cells; k++ ) {
+            if ( member[k] ) {
+                next->cell[k]  = EMPTY;
+                captured_point = k;
+                captured++;
+            }
+        }
+    }
+
+    if ( color == WHITE && get_liberties( next, WALL, member ) == 0 ) {
+        return MOVE_WALL_CAPTURED;
+    }
+
+    liberties = get_liberties( next, point, member );
+    if ( liberties == 0 ) {
+        return MOVE_ILLEGAL;
+    }
+
+    // A single stone that captured a single stone and is in atari:
+    if ( captured == 1 && liberties == 1 ) {
+        for ( k = 0, n = 0; k < count_cells; k++ ) {
+            n += member[k];
+        }
+        if ( n == 1 && ! ( color == BLACK && at_wall[point] ) ) {
+            next->ko = captured_point;
+        }
+    }
+
+    return MOVE_OK;
+}
+
+/**
+ * @brief       Reads out a position.
+ *
+ * @param[in]   pos     Position
+ * @param[in]   color   Color to move
+ * @return      true if white captures the wall
+ */
+bool is_white_win( const position_t *pos, int color )
+{
+    int point;
+    int result;
+    bool is_win;
+    int state = get_state( pos, color );
+    bool was_repeated = is_repeated;
+    position_t next;
+
+    if ( memo[state] == MEMO_OPEN ) {
+        is_repeated = true;
+        return false;
+    }
+    if ( memo[state] ) {
+        return memo[state] == MEMO_WHITE_WINS;
+    }
+    memo[state] = MEMO_OPEN;
+    is_repeated = false;
+
+    // White wins if one move wins, black if one move does not lose:
+    is_win = ( color == BLACK );
+    for ( point = INVALID; point < count_cells && is_win == ( color == BLACK ); point++ ) {
+        if ( point == INVALID && ( color == BLACK || pos->outside == 0 ) ) {
+            continue;
+        }
+        if ( point != INVALID && ( pos->cell[point] != EMPTY || point == pos->ko ) ) {
+            continue;
+        }
+
+        result = play( pos, color, point, &next );
+        if ( result == MOVE_WALL_CAPTURED ) {
+            is_win = true;
+        }
+        else if ( result == MOVE_OK ) {
+            is_win = is_white_win( &next, color * -1 );
+        }
+    }
+
+    // Pass, two passes end the game and black keeps the wall:
+    if ( is_win == ( color == BLACK ) ) {
+        if ( pos->passed ) {
+            is_win = false;
+        }
+        else {
+            next        = *pos;
+            next.ko     = INVALID;
+            next.passed = 1;
+            is_win      = is_white_win( &next, color * -1 );
+        }
+    }
+
+    if ( is_repeated ) {
+        memo[state] = 0;
+    }
+    else {
+        memo[state] = is_win ? MEMO_WHITE_WINS : MEMO_BLACK_WINS;
+    }
+    is_repeated = is_repeated || was_repeated;
+
+    return is_win;
+}
+
+/**
+ * @brief       Returns the index of a position in memo[].
+ *
+ * @param[in]   pos     Position
+ * @param[in]   color   Color to move
+ * @return      Index
+ */
+int get_state( const position_t *pos, int color )
+{
+    int k;
+    int code = 0;
+
+    // EMPTY 0, BLACK 1, WHITE 2:
+    for ( k = count_cells - 1; k >= 0; k-- ) {
+        code = code * 3 + ( ( pos->cell[k] == WHITE ) ? 2 : pos->cell[k] );
+    }
+
+    return ( ( ( code * ( OUTSIDE_LIBERTIES + 1 ) + pos->outside ) * ( EYE_SIZE_MAX + 1 )
+        + pos->ko + 1 ) * 2 + pos->passed ) * 2 + ( color == BLACK );
+}
+
+/**
+ * @brief       Compares two keys.
+ *
+ * Compare function for qsort().
+ *
+ * @param[in]   key1    First key
+ * @param[in]   key2    Second key
+ * @return      Negative, zero or positive value
+ */
+int compare_key( const void *key1, const void *key2 )
+{
+    uint64_t k1 = *(const uint64_t *)key1;
+    uint64_t k2 = *(const uint64_t *)key2;
+
+    return ( k1 > k2 ) - ( k1 < k2 );
+}
@@ -13,7 +13,7 @@
 //! Defines the current version of the program.
 #define PROGRAM_VERSION "0.1"
 //! Defines the valid command line options.
-#define VALID_OPTIONS   "hv"
+#define VALID_OPTIONS   "hvt:e:p:s:"
 
 //! Defines invalid entry.
 #define INVALID -1
@@ -66,15 +66,83 @@
 //! Defines name of log file for search tree.
 #define LOG_FILE    "haigo.log"
 
-//! Defines size of transposition hash table.
-//#define HASH_TABLE_SIZE 1048576     // 2 ^ 20
-#define HASH_TABLE_SIZE 33554432  // 2 ^ 25
+//! Defines default size of transposition hash table (number of entries, power of 2).
+//! The table is cleared at start, so the default is kept small (16 MB); use
+//! command line option -s to set a bigger one.
+#define HASH_TABLE_SIZE 1048576     // 2 ^ 20
+//#define HASH_TABLE_SIZE 33554432  // 2 ^ 25
+//! Defines the minimum and maximum size of the hash table as power of 2.
+#define HASH_TABLE_BITS_MIN 10
+#define HASH_TABLE_BITS_MAX 30
+
+//! Defines size of evaluation cache (number of entries, power of 2).
+#define EVAL_CACHE_SIZE 65536       // 2 ^ 16
 
 //! Defines maximal quiescence search depth:
 #define MAX_QSEARCH_DEPTH   3
 
+//! Defines the depth reduction of the search after a null move (pass).
+#define NULL_MOVE_REDUCTION 2
+//! Defines the number of moves of a node that are never reduced.
+#define LMR_FULL_MOVES      4
+//! Defines the evaluation margin for futility pruning at frontier nodes.
+#define FUTILITY_MARGIN     2
+
+//! Defines the number of move list entries of the move stack of a search thread.
+#define MOVE_STACK_SIZE     ( ( MAX_SEARCH_DEPTH + MAX_QSEARCH_DEPTH + 4 ) * ( BOARD_SIZE_MAX * BOARD_SIZE_MAX + 1 ) )
+
+//! Defines the maximum number of principal variations searched at the root.
+#define MAX_MULTI_PV    10
+//! Defines the maximum length of a principal variation.
+#define MAX_PV_LENGTH   ( MAX_SEARCH_DEPTH + 2 )
+
+//! Defines default number of search threads.
+#define DEFAULT_THREADS 1
+//! Defines the maximum number of search threads.
+#define MAX_THREADS     64
+//! Defines the stack size of a helper search thread in bytes.
+#define HELPER_STACK_SIZE   1048576     // 1 MB
+
+//! Defines default number of playouts of a Monte Carlo tree search.
+#define DEFAULT_PLAYOUTS    10000
+//! Defines the maximum number of playouts of a Monte Carlo tree search.
+#define MAX_PLAYOUTS        10000000
+//! Defines the exploration constant of the UCB1 formula.
+#define MCTS_UCT_C          1.4
+//! Defines the exploration constant of the UCB1 formula when RAVE is used.
+#define MCTS_RAVE_UCT_C     0.2
+//! Defines the winning rate assumed for an unvisited move without AMAF statistics (first play urgency).
+#define MCTS_FPU            0.5
+//! Defines the number of visits at which AMAF and UCT values weigh the same.
+#define MCTS_RAVE_EQUIV     1000.0
+//! Defines the number of visits of a leaf before it is expanded.
+#define MCTS_EXPAND_VISITS  2
+//! Defines the number of visits without a win added to a node while a thread simulates through it.
+#define MCTS_VIRTUAL_LOSS   3
+//! Defines the maximum depth of the Monte Carlo search tree.
+#define MCTS_MAX_DEPTH      ( BOARD_SIZE_MAX * BOARD_SIZE_MAX * 2 )
+//! Defines the number of children of a node that selection always considers.
+#define MCTS_WIDEN_MIN      4
+//! Defines the number of visits of a node at which the next child is added.
+#define MCTS_WIDEN_VISITS   20.0
+//! Defines the growth of visits of a node that adds one more child.
+#define MCTS_WIDEN_FACTOR   1.4
+//! Defines the bonus of a child with the best prior in node selection, divided by visits + 1.
+#define MCTS_PRIOR_BIAS     0.5
+//! Defines the default memory limit of the Monte Carlo search tree in MB.
+#define DEFAULT_TREE_MEMORY 256
+//! Defines the maximum memory limit of the Monte Carlo search tree in MB.
+#define MAX_TREE_MEMORY     65536
+
+//! Defines the alpha-beta search engine.
+#define ENGINE_ALPHABETA    0
+//! Defines the Monte Carlo tree search engine.
+#define ENGINE_MCTS         1
+
 //! Number of brain functions.
 #define COUNT_BRAINS    9
+//! Number of cost tiers of brain functions.
+#define EVAL_TIERS      3
 
 #endif
 
@@ -0,0 +1,238 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include "global_const.h"
+#include "hash.h"
+
+/**
+ * @file    hash.c
+ *
+ * @brief   Transposition hash table shared by all search threads.
+ *
+ * The hash table is accessed by all search threads at the same time without
+ * any locks. Every entry consists of two 64 bit words: the packed data and
+ * the hash id XORed with the data. An entry is only accepted if the hash id
+ * can be restored from both words. An entry that has been torn by two
+ * threads writing at the same time therefore is simply treated as a miss.
+ *
+ */
+
+/**
+ * @brief   Structure that represents a raw hash table entry.
+ *
+ **/
+typedef struct {
+    hash_t key;     //!< Hash id XORed with data.
+    hash_t data;    //!< Packed value, depth, flag and move.
+} hash_slot_t;
+
+static hash_slot_t *hash_table = NULL;  //!< The transposition table.
+static size_t hash_table_size = HASH_TABLE_SIZE;    //!< Number of entries, a power of 2.
+
+//! Random number added to the hash id when black is to move.
+static const hash_t hash_black_to_move = 0x9E3779B97F4A7C15ULL;
+
+//! Marks a slot as used, so an empty slot never verifies.
+#define SLOT_USED       ( 1ULL << 42 )
+
+//! Packs the move coordinates into 16 bits; 0xFFFF means no move.
+#define PACK_MOVE(i,j)  ( ( (i) == INVALID ) ? 0xFFFFULL : (hash_t)( (i) * 32 + (j) ) )
+
+
+/**
+ * @brief       Allocates the hash table.
+ *
+ * Allocates memory for the entries of the hash table and clears them. The
+ * size is HASH_TABLE_SIZE unless set by set_hash_table_size(). Calling the
+ * function again keeps the already allocated table.
+ *
+ * @return      Nothing
+ * @sa          free_hash_table()
+ */
+void init_hash_table(void)
+{
+    if ( hash_table == NULL ) {
+        hash_table = malloc( hash_table_size * sizeof(hash_slot_t) );
+        if ( hash_table == NULL ) {
+            fprintf( stderr, "cannot allocate memory for hash table\n" );
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    clear_hash_table();
+
+    return;
+}
+
+/**
+ * @brief       Frees the hash table.
+ *
+ * Frees the memory allocated by init_hash_table().
+ *
+ * @return      Nothing
+ * @sa          init_hash_table()
+ */
+void free_hash_table(void)
+{
+    free(hash_table);
+    hash_table = NULL;
+
+    return;
+}
+
+/**
+ * @brief       Sets the size of the hash table.
+ *
+ * The table is shared by all search threads, so its size is chosen for the
+ * whole program. An already allocated table is allocated again with the new
+ * size, its entries are lost.
+ *
+ * @param[in]   bits    Size of table as power of 2 (HASH_TABLE_BITS_MIN ..
+ *                      HASH_TABLE_BITS_MAX)
+ * @return      true if the size is valid
+ * @note        Must not be called while a search is running.
+ */
+bool set_hash_table_size( int bits )
+{
+
+    if ( bits < HASH_TABLE_BITS_MIN || bits > HASH_TABLE_BITS_MAX ) {
+        return false;
+    }
+
+    hash_table_size = (size_t)1 << bits;
+    if ( hash_table != NULL ) {
+        free_hash_table();
+        init_hash_table();
+    }
+
+    return true;
+}
+
+/**
+ * @brief       Returns the number of entries of the hash table.
+ *
+ * @return      Number of entries
+ */
+size_t get_hash_table_size(void)
+{
+
+    return hash_table_size;
+}
+
+/**
+ * @brief       Deletes all entries of the hash table.
+ *
+ * Deletes all entries of the hash table, e.g. for a new game.
+ *
+ * @return      Nothing
+ * @note        Must not be called while a search is running.
+ */
+void clear_hash_table(void)
+{
+    if ( hash_table != NULL ) {
+        memset( hash_table, 0, hash_table_size * sizeof(hash_slot_t) );
+    }
+
+    return;
+}
+
+/**
+ * @brief       Returns hash id part of the side to move.
+ *
+ * The board hash id does not know which color is to move. This value must be
+ * XORed to the board hash id before accessing the hash table.
+ *
+ * @param[in]   color   Color to move
+ * @return      Hash id part for color
+ */
+hash_t get_hash_color( int color )
+{
+
+    return ( color == BLACK ) ? hash_black_to_move : 0;
+}
+
+/**
+ * @brief       Stores a search result in the hash table.
+ *
+ * The entry at the slot of the given hash id is always replaced.
+ *
+ * @param[in]   hash_id Hash id of position including side to move
+ * @param[in]   depth   Remaining search depth of the stored value
+ * @param[in]   flag    HASH_EXACT|HASH_LOWER|HASH_UPPER
+ * @param[in]   value   Value of position
+ * @param[in]   i       Horizontal coordinate of best move or INVALID
+ * @param[in]   j       Vertical coordinate of best move or INVALID
+ * @return      Nothing
+ * @sa          probe_hash_table()
+ */
+void store_hash_table( hash_t hash_id, int depth, int flag, int value, int i, int j )
+{
+    hash_slot_t *slot;
+    hash_t data;
+
+    if ( hash_table == NULL ) {
+        return;
+    }
+
+    slot = &hash_table[ hash_id & ( hash_table_size - 1 ) ];
+
+    data = (hash_t)(unsigned int)value
+         | ( (hash_t)( depth & 0xFF ) << 32 )
+         | ( (hash_t)( flag  & 0x03 ) << 40 )
+         | SLOT_USED
+         | ( PACK_MOVE( i, j ) << 48 );
+
+    __atomic_store_n( &slot->key,  hash_id ^ data, __ATOMIC_RELAXED );
+    __atomic_store_n( &slot->data, data,           __ATOMIC_RELAXED );
+
+    return;
+}
+
+/**
+ * @brief       Looks up a position in the hash table.
+ *
+ * Looks up the given hash id and decodes the entry if it belongs to this
+ * position.
+ *
+ * @param[in]   hash_id Hash id of position including side to move
+ * @param[out]  entry   Decoded entry
+ * @return      true|false
+ * @sa          store_hash_table()
+ */
+bool probe_hash_table( hash_t hash_id, hash_entry_t *entry )
+{
+    hash_slot_t *slot;
+    hash_t key;
+    hash_t data;
+    int    move;
+
+    if ( hash_table == NULL ) {
+        return false;
+    }
+
+    slot = &hash_table[ hash_id & ( hash_table_size - 1 ) ];
+
+    key  = __atomic_load_n( &slot->key,  __ATOMIC_RELAXED );
+    data = __atomic_load_n( &slot->data, __ATOMIC_RELAXED );
+
+    if ( ( key ^ data ) != hash_id || ! ( data & SLOT_USED ) ) {
+        return false;
+    }
+
+    entry->value = (int)(unsigned int)( data & 0xFFFFFFFFULL );
+    entry->depth = (int)( ( data >> 32 ) & 0xFF );
+    entry->flag  = (int)( ( data >> 40 ) & 0x03 );
+
+    move = (int)( ( data >> 48 ) & 0xFFFF );
+    if ( move == 0xFFFF ) {
+        entry->i = INVALID;
+        entry->j = INVALID;
+    }
+    else {
+        entry->i = move / 32;
+        entry->j = move % 32;
+    }
+
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef HASH_H
+#define HASH_H
+
+/**
+ * @file    hash.h
+ *
+ * @brief   Interface definition for hash.c
+ *
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned long long hash_t;  //!< Type of a position hash id.
+
+#define HASH_EXACT  0   //!< Stored value is the exact value of the position.
+#define HASH_LOWER  1   //!< Stored value is a lower bound (fail high).
+#define HASH_UPPER  2   //!< Stored value is an upper bound (fail low).
+
+/**
+ * @brief   Structure that represents a decoded hash table entry.
+ *
+ **/
+typedef struct {
+    int value;      //!< Value of the position.
+    int depth;      //!< Remaining search depth the value was computed with.
+    int flag;       //!< HASH_EXACT|HASH_LOWER|HASH_UPPER
+    int i;          //!< Horizontal coordinate of best move or INVALID.
+    int j;          //!< Vertical coordinate of best move or INVALID.
+} hash_entry_t;
+
+void   init_hash_table(void);
+void   free_hash_table(void);
+void   clear_hash_table(void);
+bool   set_hash_table_size( int bits );
+size_t get_hash_table_size(void);
+hash_t get_hash_color( int color );
+void   store_hash_table( hash_t hash_id, int depth, int flag, int value, int i, int j );
+bool   probe_hash_table( hash_t hash_id, hash_entry_t *entry );
+
+#endif
+
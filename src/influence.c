@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <string.h>
+#include "global_const.h"
+#include "board.h"
+#include "board_intern.h"
+#include "influence.h"
+
+
+/**
+ * @file    influence.c
+ *
+ * @brief   Influence map after Bouzy 5/21.
+ *
+ * Black stones start with BOUZY_STONE, white stones with -BOUZY_STONE, all
+ * other vertices with zero. Then BOUZY_DILATIONS dilations and
+ * BOUZY_EROSIONS erosions are done:
+ *
+ * - Dilation: a vertex that is not negative and has no negative neighbour
+ *   gets +1 for every positive neighbour (the same for the other color).
+ * - Erosion: a positive vertex loses 1 for every neighbour on the board that
+ *   is zero or negative, but does not fall below zero (the same for the
+ *   other color).
+ *
+ * The vertices with a positive value belong to black, the ones with a
+ * negative value to white.
+ *
+ * The map is a grid of 16 bit values with a border of at least one vertex
+ * and a fixed row length for all board sizes, so the neighbour offsets are
+ * constants. Every step works on VECTOR_LENGTH vertices of a row at once
+ * with the vector extension of GCC, without branches. Vertices off the board
+ * are masked out by on_board[], which is -1 on the board and 0 elsewhere.
+ *
+ */
+
+//! Number of 16 bit values in a vector.
+#define VECTOR_LENGTH   8
+
+//! Row length of the influence grid including border, a multiple of VECTOR_LENGTH.
+#define GRID_WIDTH  ( ( BOARD_SIZE_MAX + 2 + VECTOR_LENGTH - 1 ) / VECTOR_LENGTH * VECTOR_LENGTH )
+
+//! Number of vertices of the influence grid, one extra row for loads past the last row.
+#define GRID_SIZE   ( GRID_WIDTH * ( BOARD_SIZE_MAX + 3 ) )
+
+//! Vector of 16 bit values that may be loaded from any vertex.
+typedef short vector_t __attribute__ (( vector_size( VECTOR_LENGTH * sizeof(short) ), aligned( sizeof(short) ) ));
+
+//! Macro that converts two dimensional index into grid index.
+#define GRID(i,j)   ( ( (j)+1 ) * GRID_WIDTH + (i) + 1 )
+
+static __thread short influence[2][GRID_SIZE];  //!< Current map and work copy.
+static __thread short on_board[GRID_SIZE];      //!< -1 for vertices on the board, 0 for the border.
+static __thread int   current;                  //!< Index of the current map in influence[].
+static __thread int   map_size;                 //!< Board size of the current map.
+static __thread int   vector_count;             //!< Number of vectors per row.
+
+static void dilate( const short *from, short *to );
+static void erode( const short *from, short *to );
+
+
+/**
+ * @brief       Computes the influence map of the current position.
+ *
+ * @return      Nothing
+ * @sa          get_influence()
+ */
+void compute_influence(void)
+{
+    int i, j;
+    int k;
+
+    map_size     = get_board_size();
+    vector_count = ( map_size + 2 + VECTOR_LENGTH - 1 ) / VECTOR_LENGTH;
+    current      = 0;
+
+    memset( influence, 0, sizeof(influence) );
+    memset( on_board,  0, sizeof(on_board) );
+
+    for ( i = 0; i < map_size; i++ ) {
+        for ( j = 0; j < map_size; j++ ) {
+            influence[0][ GRID(i,j) ] = (short)( get_vertex( i, j ) * BOUZY_STONE );
+            on_board[ GRID(i,j) ]     = -1;
+        }
+    }
+
+    for ( k = 0; k < BOUZY_DILATIONS; k++ ) {
+        dilate( influence[current], influence[ 1 - current ] );
+        current = 1 - current;
+    }
+    for ( k = 0; k < BOUZY_EROSIONS; k++ ) {
+        erode( influence[current], influence[ 1 - current ] );
+        current = 1 - current;
+    }
+
+    return;
+}
+
+/**
+ * @brief       Returns the influence of a vertex.
+ *
+ * @param[in]   i   Horizontal coordinate
+ * @param[in]   j   Vertical coordinate
+ * @return      Positive for black, negative for white, zero for neutral
+ * @note        compute_influence() must have been called before.
+ */
+int get_influence( int i, int j )
+{
+
+    return influence[current][ GRID(i,j) ];
+}
+
+/**
+ * @brief       Counts the vertices controlled by black and white.
+ *
+ * @return      Number of black vertices minus number of white vertices
+ * @note        compute_influence() must have been called before.
+ */
+int get_influence_territory(void)
+{
+    int v;
+    int count = 0;
+    const short *map = influence[current];
+
+    // Border vertices are zero and do not count:
+    for ( v = 0; v < GRID_SIZE; v++ ) {
+        count += ( map[v] > 0 ) - ( map[v] < 0 );
+    }
+
+    return count;
+}
+
+/**
+ * @brief       Returns the influence map as string.
+ *
+ * The influence map of the current position is computed and printed with
+ * the same coordinates as the board.
+ *
+ * @param[out]  output  Influence map
+ * @return      Nothing
+ */
+void get_bouzy_as_string( char output[] )
+{
+    int i, j;
+    char x[2];
+    char y[3];
+    char buffer[8];
+
+    compute_influence();
+
+    output[0] = '\0';
+    strcat( output, "\n   " );
+    for ( i = 0; i < map_size; i++ ) {
+        get_label_x( i, x );
+        snprintf( buffer, 8, "%5s", x );
+        strcat( output, buffer );
+    }
+    strcat( output, "\n" );
+
+    for ( j = map_size - 1; j >= 0; j-- ) {
+        get_label_y_left( j, y );
+        strcat( output, " " );
+        strcat( output, y );
+        for ( i = 0; i < map_size; i++ ) {
+            snprintf( buffer, 8, "%5d", get_influence( i, j ) );
+            strcat( output, buffer );
+        }
+        strcat( output, "\n" );
+    }
+
+    return;
+}
+
+/**
+ * @brief       Does one dilation step.
+ *
+ * @param[in]   from    Map before the step
+ * @param[out]  to      Map after the step
+ * @return      Nothing
+ */
+void dilate( const short *from, short *to )
+{
+    int j;
+    int k;
+    int v;
+    vector_t n, e, s, w;
+    vector_t x;
+    vector_t positive;
+    vector_t negative;
+
+    for ( j = 0; j < map_size; j++ ) {
+        for ( k = 0; k < vector_count; k++ ) {
+            v = GRID( -1, j ) + k * VECTOR_LENGTH;
+            n = *(const vector_t *)&from[ v - GRID_WIDTH ];
+            e = *(const vector_t *)&from[ v + 1 ];
+            s = *(const vector_t *)&from[ v + GRID_WIDTH ];
+            w = *(const vector_t *)&from[ v - 1 ];
+            x = *(const vector_t *)&from[v];
+
+            // Comparisons give -1 for true:
+            positive = -( ( n > 0 ) + ( e > 0 ) + ( s > 0 ) + ( w > 0 ) );
+            negative = -( ( n < 0 ) + ( e < 0 ) + ( s < 0 ) + ( w < 0 ) );
+
+            x += positive & ( ( x >= 0 ) & ( negative == 0 ) );
+            x -= negative & ( ( x <= 0 ) & ( positive == 0 ) );
+
+            *(vector_t *)&to[v] = x & *(const vector_t *)&on_board[v];
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief       Does one erosion step.
+ *
+ * @param[in]   from    Map before the step
+ * @param[out]  to      Map after the step
+ * @return      Nothing
+ */
+void erode( const short *from, short *to )
+{
+    int j;
+    int k;
+    int v;
+    vector_t n, e, s, w;
+    vector_t x;
+    vector_t not_positive;
+    vector_t not_negative;
+    vector_t shrunk_positive;
+    vector_t shrunk_negative;
+
+    for ( j = 0; j < map_size; j++ ) {
+        for ( k = 0; k < vector_count; k++ ) {
+            v = GRID( -1, j ) + k * VECTOR_LENGTH;
+            n = *(const vector_t *)&from[ v - GRID_WIDTH ];
+            e = *(const vector_t *)&from[ v + 1 ];
+            s = *(const vector_t *)&from[ v + GRID_WIDTH ];
+            w = *(const vector_t *)&from[ v - 1 ];
+            x = *(const vector_t *)&from[v];
+
+            // Border vertices are zero, but do not erode:
+            not_positive = -( ( ( n <= 0 ) & *(const vector_t *)&on_board[ v - GRID_WIDTH ] )
+                            + ( ( e <= 0 ) & *(const vector_t *)&on_board[ v + 1 ] )
+                            + ( ( s <= 0 ) & *(const vector_t *)&on_board[ v + GRID_WIDTH ] )
+                            + ( ( w <= 0 ) & *(const vector_t *)&on_board[ v - 1 ] ) );
+            not_negative = -( ( ( n >= 0 ) & *(const vector_t *)&on_board[ v - GRID_WIDTH ] )
+                            + ( ( e >= 0 ) & *(const vector_t *)&on_board[ v + 1 ] )
+                            + ( ( s >= 0 ) & *(const vector_t *)&on_board[ v + GRID_WIDTH ] )
+                            + ( ( w >= 0 ) & *(const vector_t *)&on_board[ v - 1 ] ) );
+
+            // Values do not cross zero:
+            shrunk_positive = x - not_positive;
+            shrunk_negative = x + not_negative;
+            x = ( shrunk_positive & ( ( x > 0 ) & ( shrunk_positive > 0 ) ) )
+              | ( shrunk_negative & ( ( x < 0 ) & ( shrunk_negative < 0 ) ) );
+
+            *(vector_t *)&to[v] = x;
+        }
+    }
+
+    return;
+}
@@ -0,0 +1,23 @@
+#ifndef INFLUENCE_H
+#define INFLUENCE_H
+
+/**
+ * @file    influence.h
+ *
+ * @brief   Interface definition for influence.c
+ *
+ */
+
+#include "global_const.h"
+
+#define BOUZY_DILATIONS 5       //!< Number of dilations of Bouzy 5/21.
+#define BOUZY_EROSIONS  21      //!< Number of erosions of Bouzy 5/21.
+#define BOUZY_STONE     128     //!< Start value of a black stone, white is negative.
+
+void compute_influence(void);
+int  get_influence( int i, int j );
+int  get_influence_territory(void);
+void get_bouzy_as_string( char output[] );
+
+#endif
+
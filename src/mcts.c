@@ -0,0 +1,1134 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include "global_const.h"
+#include "hash.h"
+#include "board.h"
+#include "move.h"
+#include "global_tools.h"
+#include "search.h"
+#include "playout.h"
+#include "mcts.h"
+
+
+/**
+ * @file    mcts.c
+ *
+ * @brief   Monte Carlo tree search engine.
+ *
+ * An alternative to the alpha-beta search of search.c. The function
+ * mcts_search() grows a tree from the current position. Every iteration
+ * walks down the tree by UCB1 selection, expands the reached leaf, plays a
+ * random game to the end on the light board of playout.c and scores it. The
+ * result is propagated back to the root. After the set number of playouts
+ * the most visited move of the root is returned.
+ *
+ * Every node stores the number of wins for the color that made the move
+ * leading to it. The children of a node are sorted by a prior, the weight of
+ * the move on the playout board (3x3 pattern, captures and atari escapes),
+ * scaled to [0,1] by the weight of the best sibling. Selection only considers the first children, more are added as the number
+ * of visits of the node grows (progressive widening). The prior also adds a
+ * bonus to the value of a child that fades with its visits.
+ *
+ * With RAVE every node also collects AMAF statistics: every simulation in
+ * which its color played the move at any later time counts as if the move
+ * had been played at once.
+ *
+ * If more than one thread is set (see set_thread_count()), all threads work
+ * on the same tree without locks:
+ *
+ * - All node statistics are updated with atomic operations.
+ * - A thread adds a virtual loss (MCTS_VIRTUAL_LOSS visits without a win)
+ *   to every node it selects, so other threads prefer different paths
+ *   until the result of its simulation is known.
+ * - A node is expanded by the thread that wins a compare-and-swap on its
+ *   state. Other threads treat it as a leaf until the children are
+ *   published.
+ *
+ * The tree is kept after the search. mcts_play_move() follows every move
+ * played in the game, promotes the subtree of the move to the new root and
+ * frees the rest. The next search continues with this subtree if it is
+ * called for the same position.
+ *
+ * All nodes are taken from a pool that is allocated once with the size of
+ * the memory limit (see set_tree_memory()). Child nodes of a node are a
+ * contiguous block of the pool, addressed by their index. When the pool is
+ * full, leaves are not expanded any more but simulations go on. After
+ * mcts_play_move() the remaining subtree is slid to the start of the pool,
+ * which frees the space of all other nodes without any further memory.
+ *
+ * While the program waits for the next GTP command, start_pondering() can
+ * grow the kept tree on background threads. stop_pondering() stops these
+ * threads, the playouts done so far stay in the tree.
+ *
+ */
+
+#define NODE_LEAF       0   //!< Node has no children yet.
+#define NODE_EXPANDING  1   //!< A thread is creating the children of the node.
+#define NODE_EXPANDED   2   //!< Children of the node may be used.
+#define NODE_LIVE       16  //!< Flag of state: node is kept by compact_tree().
+#define NODE_THREADED   32  //!< Flag of state: visits holds the index of the parent.
+
+//! Returned by alloc_nodes() when the pool is full.
+#define POOL_FULL       UINT_MAX
+#define PRIOR_ONE       USHRT_MAX   //!< Prior of the best child of a node.
+
+/**
+ * @brief   Structure that represents a node of the search tree.
+ *
+ * The size is 28 bytes.
+ *
+ **/
+typedef struct mcts_node_st {
+    signed char  color;                 //!< Color that made the move.
+    signed char  state;                 //!< NODE_LEAF|NODE_EXPANDING|NODE_EXPANDED
+    unsigned short prior;               //!< Weight of move relative to the best sibling, PRIOR_ONE is 1.
+    short        vertex;                //!< Index of move on playout board.
+    short        nr_of_children;        //!< Number of child nodes.
+    unsigned int visits;                //!< Number of playouts through node.
+    unsigned int wins;                  //!< Number of playouts won by color.
+    unsigned int amaf_visits;           //!< Number of playouts where color played the move later.
+    unsigned int amaf_wins;             //!< Number of those playouts won by color.
+    unsigned int children;              //!< Pool index of first child node.
+} mcts_node_t;
+
+/**
+ * @brief   Structure that describes a search thread.
+ *
+ **/
+typedef struct {
+    pthread_t thread;                       //!< Thread handle.
+    int       thread_nr;                    //!< Number of thread, starting with 0.
+    unsigned int seed;                      //!< Seed of random number generator.
+    int       color;                        //!< Color to move at the root.
+    float     komi;                         //!< Komi.
+    mcts_node_t           *root;            //!< Root of the shared tree.
+    const playout_board_t *root_board;      //!< Position of the root.
+    unsigned long long int node_count;      //!< Number of nodes created by thread.
+    int       max_depth;                    //!< Maximum depth of a simulation in the tree.
+} worker_t;
+
+static int  playouts = DEFAULT_PLAYOUTS;    //!< Number of playouts per search.
+static bool use_rave = true;                //!< Use AMAF values for node selection.
+static int  playouts_started;               //!< Number of simulations started by all threads.
+static int  playouts_done;                  //!< Number of simulations completed by all threads.
+static int  playout_limit;                  //!< Number of simulations to start.
+static bool stop_search;                    //!< Set to stop all search threads.
+
+static mcts_node_t  *node_pool = NULL;       //!< Memory for all tree nodes.
+static unsigned int  pool_size = 0;          //!< Number of nodes in pool.
+static unsigned int  pool_used = 0;          //!< Number of nodes taken from pool.
+static int           tree_memory = DEFAULT_TREE_MEMORY;    //!< Memory limit of pool in MB.
+
+static mcts_node_t *tree_root = NULL;       //!< Root of the kept search tree.
+static int     tree_color;                  //!< Color to move at the root of the kept tree.
+static hash_t  tree_hash;                   //!< Hash id of the position of the kept tree.
+static bsize_t tree_board_size;             //!< Board size of the kept tree.
+static float   tree_komi;                   //!< Komi of the kept tree.
+
+static int             ponder_threads = 0;          //!< Number of running ponder threads.
+static worker_t        ponder_workers[MAX_THREADS]; //!< Ponder threads.
+static playout_board_t ponder_board;                //!< Position of the ponder search.
+
+static __thread unsigned long long int node_count;     //!< Number of tree nodes created.
+
+static void init_node( mcts_node_t *node, int vertex, int color, int prior );
+static void get_move( int vertex, int *i, int *j );
+static int  compare_prior( const void *move1, const void *move2 );
+static void init_node_pool(void);
+static unsigned int alloc_nodes( int count );
+static mcts_node_t *get_children( const mcts_node_t *node );
+static void thread_tree( unsigned int index );
+static unsigned int compact_tree( unsigned int root );
+static bool is_tree_valid( int color, float komi );
+static mcts_node_t *get_search_root( int color, float komi, playout_board_t *root_board );
+static void init_workers( worker_t workers[], int count, mcts_node_t *root, const playout_board_t *root_board, int color, float komi );
+static bool expand_node( mcts_node_t *node, int color, const playout_board_t *pb );
+static bool try_expand_node( mcts_node_t *node, int color, const playout_board_t *pb );
+static mcts_node_t *select_child( mcts_node_t *node );
+static void update_amaf( mcts_node_t *node, const signed char amaf_color[], int winner );
+static void run_simulations( worker_t *worker );
+static void *run_worker( void *arg );
+
+
+/**
+ * @brief       Searches best move with Monte Carlo tree search.
+ *
+ * Builds a search tree for the current position with the set number of
+ * playouts and returns the most visited move. The board is unchanged
+ * afterwards. Statistics of the search are stored with set_search_stats().
+ *
+ * If the tree kept from the last search belongs to the current position, the
+ * new playouts are added to it.
+ *
+ * @param[in]   color       Color to move
+ * @param[in]   komi        Komi
+ * @param[out]  *i_selected Pointer to horizontal coordinate of selected move.
+ * @param[out]  *j_selected Pointer to vertical coordinate of selected move.
+ * @return      Nothing
+ * @note        If no move is selected i and j are INVALID.
+ */
+void mcts_search( int color, float komi, int *i_selected, int *j_selected )
+{
+    int k;
+    int nr_of_helpers = 0;
+    int nr_of_threads = get_thread_count();
+    int max_tree_depth;
+    unsigned long long int total_nodes;
+    int              reused_visits;
+    mcts_node_t     *root;
+    mcts_node_t     *best;
+    playout_board_t  root_board;
+    worker_t         workers[MAX_THREADS];
+    pthread_attr_t   attr;
+    search_stats_t   stats;
+    struct timespec  start;
+    struct timespec  stop;
+    long long int    diff_msec;
+    char x[2];
+    char y[3];
+
+    (void) clock_gettime( CLOCK_MONOTONIC, &start );
+
+    node_count = 0;
+
+    stop_pondering();
+
+    root          = get_search_root( color, komi, &root_board );
+    reused_visits = root->visits;
+
+    playouts_started = 0;
+    playouts_done    = 0;
+    playout_limit    = playouts;
+    stop_search      = false;
+    init_workers( workers, nr_of_threads, root, &root_board, color, komi );
+
+    // Start helper threads, the main thread is worker 0:
+    if ( nr_of_threads > 1 && root->nr_of_children > 0 ) {
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize( &attr, HELPER_STACK_SIZE );
+        for ( k = 1; k < nr_of_threads; k++ ) {
+            if ( pthread_create( &workers[k].thread, &attr, run_worker, &workers[k] ) != 0 ) {
+                break;
+            }
+            nr_of_helpers++;
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    run_simulations(&workers[0]);
+
+    total_nodes    = node_count;
+    max_tree_depth = workers[0].max_depth;
+    for ( k = 1; k <= nr_of_helpers; k++ ) {
+        pthread_join( workers[k].thread, NULL );
+        total_nodes += workers[k].node_count;
+        if ( workers[k].max_depth > max_tree_depth ) {
+            max_tree_depth = workers[k].max_depth;
+        }
+    }
+
+    // Select most visited move:
+    best = NULL;
+    for ( k = 0; k < root->nr_of_children; k++ ) {
+        if ( best == NULL || get_children(root)[k].visits > best->visits ) {
+            best = &get_children(root)[k];
+        }
+    }
+
+    (void) clock_gettime( CLOCK_MONOTONIC, &stop );
+    diff_msec = (long long int)( stop.tv_sec - start.tv_sec ) * 1000
+              + ( stop.tv_nsec - start.tv_nsec ) / 1000000;
+    if ( diff_msec <= 0 ) {
+        diff_msec = 1;
+    }
+
+    // Save some stats about this search:
+    init_search_stats();
+    stats = get_search_stats();
+    my_strcpy( stats.color, ( color == BLACK ) ? "Black" : "White", 6 );
+    stats.move[0] = '\0';
+    *i_selected = INVALID;
+    *j_selected = INVALID;
+    if ( best != NULL ) {
+        get_move( best->vertex, i_selected, j_selected );
+        i_to_x( *i_selected, x );
+        j_to_y( *j_selected, y );
+        strcat( stats.move, x );
+        strcat( stats.move, y );
+        // Winning rate in percent from the view of black:
+        stats.value = best->visits > 0 ? best->wins * 100 / best->visits : 0;
+        if ( color == WHITE ) {
+            stats.value = 100 - stats.value;
+        }
+    }
+    stats.playouts      = playouts_done;
+    stats.reused_visits = reused_visits;
+    stats.tree_nodes    = pool_used;
+    stats.level         = max_tree_depth;
+    stats.duration      = stop.tv_sec - start.tv_sec;
+    stats.node_count    = total_nodes;
+    stats.nodes_per_sec = total_nodes * 1000 / diff_msec;
+    stats.playouts_per_sec = (unsigned long long int)stats.playouts * 1000 / diff_msec;
+    stats.threads       = nr_of_helpers + 1;
+    set_search_stats(&stats);
+
+    return;
+}
+
+/**
+ * @brief       Starts searching the current position in the background.
+ *
+ * Starts the set number of threads that add playouts to the kept tree of
+ * the current position until stop_pondering() is called or MAX_PLAYOUTS
+ * playouts are done. The board must not be changed while pondering.
+ *
+ * @param[in]   color   Color to move
+ * @param[in]   komi    Komi
+ * @return      Nothing
+ */
+void start_pondering( int color, float komi )
+{
+    int k;
+    int nr_of_threads = get_thread_count();
+    mcts_node_t    *root;
+    pthread_attr_t  attr;
+
+    stop_pondering();
+
+    root = get_search_root( color, komi, &ponder_board );
+    if ( root->nr_of_children == 0 ) {
+        return;
+    }
+
+    playouts_started = 0;
+    playouts_done    = 0;
+    playout_limit    = MAX_PLAYOUTS;
+    stop_search      = false;
+    init_workers( ponder_workers, nr_of_threads, root, &ponder_board, color, komi );
+
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize( &attr, HELPER_STACK_SIZE );
+    for ( k = 0; k < nr_of_threads; k++ ) {
+        if ( pthread_create( &ponder_workers[k].thread, &attr, run_worker, &ponder_workers[k] ) != 0 ) {
+            break;
+        }
+        ponder_threads++;
+    }
+    pthread_attr_destroy(&attr);
+
+    return;
+}
+
+/**
+ * @brief       Stops the background search.
+ *
+ * Waits until all ponder threads have finished their current simulation.
+ * Does nothing if the program is not pondering.
+ *
+ * @return      Nothing
+ */
+void stop_pondering(void)
+{
+    int k;
+
+    __atomic_store_n( &stop_search, true, __ATOMIC_RELAXED );
+
+    for ( k = 0; k < ponder_threads; k++ ) {
+        pthread_join( ponder_workers[k].thread, NULL );
+    }
+    ponder_threads = 0;
+
+    return;
+}
+
+/**
+ * @brief       Checks if the program is pondering.
+ *
+ * @return      true|false
+ */
+bool is_pondering(void)
+{
+
+    return ponder_threads > 0;
+}
+
+/**
+ * @brief       Follows a move played in the game.
+ *
+ * Promotes the subtree of the given move to the root of the kept search
+ * tree and frees the rest of the tree. The subtree is moved to the start of
+ * the node pool by compact_tree(). If the move is not part of the tree, the whole tree is
+ * freed. A pass is given as INVALID coordinates.
+ *
+ * @param[in]   color   Color of the move
+ * @param[in]   i       Horizontal coordinate or INVALID
+ * @param[in]   j       Vertical coordinate or INVALID
+ * @return      Nothing
+ * @note        Must be called after the move has been played on the board.
+ */
+void mcts_play_move( int color, int i, int j )
+{
+    int k;
+    int vertex;
+    mcts_node_t *child = NULL;
+
+    stop_pondering();
+
+    if ( tree_root == NULL ) {
+        return;
+    }
+
+    if ( color == tree_color && i != INVALID ) {
+        vertex = ( j + 1 ) * ( tree_board_size + 2 ) + ( i + 1 );
+        for ( k = 0; k < tree_root->nr_of_children; k++ ) {
+            if ( get_children(tree_root)[k].vertex == vertex ) {
+                child = &get_children(tree_root)[k];
+                break;
+            }
+        }
+    }
+    if ( child == NULL || child->visits == 0 ) {
+        free_search_tree();
+        return;
+    }
+
+    pool_used  = compact_tree( (unsigned int)( child - node_pool ) );
+    tree_root  = &node_pool[0];
+    tree_color = color * -1;
+    tree_hash  = get_hash_id();
+
+    return;
+}
+
+/**
+ * @brief       Frees the kept search tree.
+ *
+ * @return      Nothing
+ */
+void free_search_tree(void)
+{
+
+    stop_pondering();
+
+    tree_root = NULL;
+    pool_used = 0;
+
+    return;
+}
+
+/**
+ * @brief       Checks if the kept search tree belongs to the current position.
+ *
+ * @param[in]   color   Color to move
+ * @param[in]   komi    Komi
+ * @return      true|false
+ */
+bool is_tree_valid( int color, float komi )
+{
+
+    return tree_root != NULL
+        && tree_color      == color
+        && tree_komi       == komi
+        && tree_board_size == get_board_size()
+        && tree_hash       == get_hash_id();
+}
+
+/**
+ * @brief       Returns the root of the search tree for the current position.
+ *
+ * Continues with the kept tree if it belongs to the current position,
+ * otherwise a new tree is created. The root is expanded and becomes the kept
+ * tree.
+ *
+ * @param[in]   color       Color to move
+ * @param[in]   komi        Komi
+ * @param[out]  root_board  Playout board of the current position
+ * @return      Root node
+ */
+mcts_node_t *get_search_root( int color, float komi, playout_board_t *root_board )
+{
+    int ko_i = INVALID;
+    int ko_j = INVALID;
+    mcts_node_t *root;
+
+    // A ko is only forbidden if the opponent has just taken it:
+    if ( get_move_last_color() == color * -1 ) {
+        ko_i = get_move_last_ko_i();
+        ko_j = get_move_last_ko_j();
+    }
+    init_playout_board( root_board, ko_i, ko_j );
+
+    if ( is_tree_valid( color, komi ) ) {
+        root = tree_root;
+    }
+    else {
+        free_search_tree();
+        init_node_pool();
+        root = &node_pool[ alloc_nodes(1) ];
+        init_node( root, 0, color * -1, 0 );
+    }
+    if ( root->state != NODE_EXPANDED ) {
+        expand_node( root, color, root_board );
+    }
+
+    tree_root       = root;
+    tree_color      = color;
+    tree_hash       = get_hash_id();
+    tree_board_size = get_board_size();
+    tree_komi       = komi;
+
+    return root;
+}
+
+/**
+ * @brief       Initialises the descriptions of search threads.
+ *
+ * @param[out]  workers     Array of thread descriptions
+ * @param[in]   count       Number of threads
+ * @param[in]   root        Root of the shared tree
+ * @param[in]   root_board  Position of the root
+ * @param[in]   color       Color to move at the root
+ * @param[in]   komi        Komi
+ * @return      Nothing
+ */
+void init_workers( worker_t workers[], int count, mcts_node_t *root, const playout_board_t *root_board, int color, float komi )
+{
+    int k;
+
+    for ( k = 0; k < count; k++ ) {
+        workers[k].thread_nr  = k;
+        workers[k].color      = color;
+        workers[k].komi       = komi;
+        workers[k].root       = root;
+        workers[k].root_board = root_board;
+        workers[k].node_count = 0;
+        workers[k].max_depth  = 0;
+        workers[k].seed       = get_playout_random();
+    }
+
+    return;
+}
+
+/**
+ * @brief       Runs simulations until enough playouts are started.
+ *
+ * The threads stop when the playout limit is reached or the search is
+ * stopped. Completed simulations are counted in playouts_done.
+ *
+ * Every simulation selects a path through the shared tree, expands the
+ * reached leaf, plays a random game and updates the statistics of the
+ * path.
+ *
+ * @param[in,out] worker    Description of the search thread
+ * @return      Nothing
+ */
+void run_simulations( worker_t *worker )
+{
+    int k;
+    int depth;
+    int winner;
+    int to_move;
+    int nr_of_turns;
+    mcts_node_t *node;
+    mcts_node_t *path[MCTS_MAX_DEPTH + 2];
+    short        playout_moves[BOARD_SIZE_MAX * BOARD_SIZE_MAX * 3];
+    signed char  amaf_color[PLAYOUT_BOARD_MAX];
+    playout_board_t board;
+    unsigned long long int nodes_before = node_count;
+
+    if ( worker->root->nr_of_children == 0 ) {
+        return;
+    }
+
+    while ( ! __atomic_load_n( &stop_search, __ATOMIC_RELAXED )
+            && __atomic_fetch_add( &playouts_started, 1, __ATOMIC_RELAXED ) < playout_limit ) {
+        board   = *worker->root_board;
+        node    = worker->root;
+        to_move = worker->color;
+        depth   = 0;
+        path[depth++] = node;
+        __atomic_fetch_add( &node->visits, MCTS_VIRTUAL_LOSS, __ATOMIC_RELAXED );
+
+        // Selection:
+        while ( depth <= MCTS_MAX_DEPTH ) {
+            if ( __atomic_load_n( &node->state, __ATOMIC_ACQUIRE ) != NODE_EXPANDED ) {
+                // Expansion:
+                if ( __atomic_load_n( &node->visits, __ATOMIC_RELAXED ) < MCTS_EXPAND_VISITS + MCTS_VIRTUAL_LOSS
+                        || ! try_expand_node( node, to_move, &board ) ) {
+                    break;
+                }
+            }
+            if ( node->nr_of_children == 0 ) {
+                break;
+            }
+            node = select_child(node);
+            __atomic_fetch_add( &node->visits, MCTS_VIRTUAL_LOSS, __ATOMIC_RELAXED );
+            play_playout_vertex( &board, to_move, node->vertex );
+            path[depth++] = node;
+            to_move *= -1;
+        }
+        if ( depth > worker->max_depth ) {
+            worker->max_depth = depth;
+        }
+
+        // Simulation:
+        nr_of_turns = play_random_playout( &board, to_move, playout_moves );
+        winner = ( get_playout_score( &board, worker->komi ) > 0 ) ? BLACK : WHITE;
+
+        // First color that played on a vertex in the playout:
+        memset( amaf_color, EMPTY, sizeof(amaf_color) );
+        for ( k = nr_of_turns - 1; k >= 0; k-- ) {
+            if ( playout_moves[k] != 0 ) {
+                amaf_color[ playout_moves[k] ] = ( k % 2 == 0 ) ? to_move : to_move * -1;
+            }
+        }
+
+        // Backpropagation, the virtual loss becomes one real visit:
+        for ( k = depth - 1; k >= 0; k-- ) {
+            __atomic_fetch_sub( &path[k]->visits, MCTS_VIRTUAL_LOSS - 1, __ATOMIC_RELAXED );
+            if ( path[k]->color == winner ) {
+                __atomic_fetch_add( &path[k]->wins, 1, __ATOMIC_RELAXED );
+            }
+            if ( use_rave && __atomic_load_n( &path[k]->state, __ATOMIC_ACQUIRE ) == NODE_EXPANDED ) {
+                update_amaf( path[k], amaf_color, winner );
+            }
+            // The move of the node comes first for all nodes above:
+            amaf_color[ path[k]->vertex ] = path[k]->color;
+        }
+        __atomic_fetch_add( &playouts_done, 1, __ATOMIC_RELAXED );
+    }
+
+    worker->node_count = node_count - nodes_before;
+
+    return;
+}
+
+/**
+ * @brief       Main function of a helper search thread.
+ *
+ * @param[in]   arg     Pointer to worker_t struct of this thread
+ * @return      NULL
+ */
+void *run_worker( void *arg )
+{
+    worker_t *worker = (worker_t *)arg;
+
+    set_playout_seed( worker->seed );
+    node_count = 0;
+
+    run_simulations(worker);
+
+    return NULL;
+}
+
+/**
+ * @brief       Initialises a tree node.
+ *
+ * @param[out]  node    Node to initialise
+ * @param[in]   vertex  Index of move on playout board
+ * @param[in]   color   Color that made the move
+ * @param[in]   prior   Prior of move, 0 to PRIOR_ONE
+ * @return      Nothing
+ */
+void init_node( mcts_node_t *node, int vertex, int color, int prior )
+{
+    node->vertex         = vertex;
+    node->color          = color;
+    node->prior          = prior;
+    node->state          = NODE_LEAF;
+    node->visits         = 0;
+    node->wins           = 0;
+    node->amaf_visits    = 0;
+    node->amaf_wins      = 0;
+    node->nr_of_children = 0;
+    node->children       = 0;
+
+    node_count++;
+
+    return;
+}
+
+/**
+ * @brief       Creates the children of a node.
+ *
+ * A child is created for every legal move of the given color, except for
+ * moves that fill an own eye. The children are sorted by their prior, the
+ * weight of the move divided by the biggest weight. They are published by setting the state of the node to NODE_EXPANDED.
+ *
+ * @param[in,out] node  Node to expand
+ * @param[in]   color   Color to move
+ * @param[in]   pb      Position of the node
+ * @return      false if the node pool is full
+ * @note        Only the thread that owns the node may call this function.
+ */
+bool expand_node( mcts_node_t *node, int color, const playout_board_t *pb )
+{
+    int k;
+    int count;
+    int prior;
+    int moves[BOARD_SIZE_MAX * BOARD_SIZE_MAX][2];
+    unsigned int children = 0;
+
+    count = get_playout_moves( pb, color, moves );
+
+    if ( count > 0 ) {
+        children = alloc_nodes(count);
+        if ( children == POOL_FULL ) {
+            return false;
+        }
+
+        // Replace coordinates by vertex and weight, best weight first:
+        for ( k = 0; k < count; k++ ) {
+            moves[k][0] = get_playout_vertex( pb, moves[k][0], moves[k][1] );
+            moves[k][1] = get_playout_weight( pb, color, moves[k][0] );
+        }
+        qsort( moves, (size_t)count, sizeof(moves[0]), compare_prior );
+
+        for ( k = 0; k < count; k++ ) {
+            prior = ( moves[0][1] > 0 ) ? (int)( (long long)moves[k][1] * PRIOR_ONE / moves[0][1] ) : 0;
+            init_node( &node_pool[ children + k ], moves[k][0], color, prior );
+        }
+    }
+
+    node->children       = children;
+    node->nr_of_children = count;
+    __atomic_store_n( &node->state, NODE_EXPANDED, __ATOMIC_RELEASE );
+
+    return true;
+}
+
+/**
+ * @brief       Allocates the node pool.
+ *
+ * The pool is allocated with the size of the memory limit when it is first
+ * used. Does nothing if it exists already.
+ *
+ * @return      Nothing
+ */
+void init_node_pool(void)
+{
+    size_t size;
+
+    if ( node_pool != NULL ) {
+        return;
+    }
+
+    size = (size_t)tree_memory * 1024 * 1024 / sizeof(mcts_node_t);
+    if ( size >= POOL_FULL ) {
+        size = POOL_FULL - 1;
+    }
+
+    node_pool = malloc( size * sizeof(mcts_node_t) );
+    if ( node_pool == NULL ) {
+        fprintf( stderr, "cannot allocate memory for search tree\n" );
+        exit(EXIT_FAILURE);
+    }
+    pool_size = (unsigned int)size;
+    pool_used = 0;
+
+    return;
+}
+
+/**
+ * @brief       Frees the node pool.
+ *
+ * @return      Nothing
+ */
+void free_node_pool(void)
+{
+
+    free_search_tree();
+    free(node_pool);
+    node_pool = NULL;
+    pool_size = 0;
+
+    return;
+}
+
+/**
+ * @brief       Takes a block of nodes from the pool.
+ *
+ * @param[in]   count   Number of nodes
+ * @return      Pool index of first node or POOL_FULL
+ */
+unsigned int alloc_nodes( int count )
+{
+    unsigned int used = __atomic_load_n( &pool_used, __ATOMIC_RELAXED );
+
+    do {
+        if ( pool_size - used < (unsigned int)count ) {
+            return POOL_FULL;
+        }
+    } while ( ! __atomic_compare_exchange_n( &pool_used, &used, used + count
+            , true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) );
+
+    return used;
+}
+
+/**
+ * @brief       Returns the children of a node.
+ *
+ * @param[in]   node    Tree node
+ * @return      Pointer to first child node
+ */
+mcts_node_t *get_children( const mcts_node_t *node )
+{
+
+    return &node_pool[ node->children ];
+}
+
+/**
+ * @brief       Marks a subtree as live and threads its child blocks.
+ *
+ * The child block of a node is only referenced by the children index of the
+ * node. This reference is turned around: the first child keeps the index of
+ * the node in its visits and the node keeps the visits of the first child
+ * in its children index, see compact_tree().
+ *
+ * @param[in]   index   Pool index of root of subtree
+ * @return      Nothing
+ */
+void thread_tree( unsigned int index )
+{
+    int k;
+    mcts_node_t *node  = &node_pool[index];
+    unsigned int first = node->children;
+
+    node->state |= NODE_LIVE;
+
+    if ( node->nr_of_children > 0 ) {
+        for ( k = 0; k < node->nr_of_children; k++ ) {
+            thread_tree( first + k );
+        }
+        node->children           = node_pool[first].visits;
+        node_pool[first].visits  = index;
+        node_pool[first].state  |= NODE_THREADED;
+    }
+
+    return;
+}
+
+/**
+ * @brief       Moves a subtree to the start of the pool.
+ *
+ * Sliding compaction inside the pool: the nodes of the subtree keep their
+ * order and are moved down over the free space. Children are always
+ * behind their parent in the pool, so the root of the subtree gets index 0.
+ * The new index of every child block is found by one pass over the threaded
+ * subtree (see thread_tree()), a second pass moves the nodes.
+ *
+ * @param[in]   root    Pool index of root of subtree
+ * @return      Number of nodes of subtree
+ * @note        No other thread may use the tree.
+ */
+unsigned int compact_tree( unsigned int root )
+{
+    unsigned int index;
+    unsigned int parent;
+    unsigned int live = 0;
+    mcts_node_t *node;
+
+    thread_tree(root);
+
+    // New index of every first child, restore the visits:
+    for ( index = root; index < pool_used; index++ ) {
+        node = &node_pool[index];
+        if ( ! ( node->state & NODE_LIVE ) ) {
+            continue;
+        }
+        if ( node->state & NODE_THREADED ) {
+            parent                      = node->visits;
+            node->visits                = node_pool[parent].children;
+            node_pool[parent].children  = live;
+        }
+        live++;
+    }
+
+    // Move the nodes, the target is never behind the source:
+    live = 0;
+    for ( index = root; index < pool_used; index++ ) {
+        node = &node_pool[index];
+        if ( ! ( node->state & NODE_LIVE ) ) {
+            continue;
+        }
+        node->state &= ~( NODE_LIVE | NODE_THREADED );
+        node_pool[ live++ ] = *node;
+    }
+
+    return live;
+}
+
+/**
+ * @brief       Expands a node unless another thread does it.
+ *
+ * @param[in,out] node  Node to expand
+ * @param[in]   color   Color to move
+ * @param[in]   pb      Position of the node
+ * @return      true if the node is expanded now
+ */
+bool try_expand_node( mcts_node_t *node, int color, const playout_board_t *pb )
+{
+    signed char expected = NODE_LEAF;
+
+    if ( ! __atomic_compare_exchange_n( &node->state, &expected, NODE_EXPANDING
+            , false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) ) {
+        return false;
+    }
+
+    if ( ! expand_node( node, color, pb ) ) {
+        // Pool is full, node stays a leaf:
+        __atomic_store_n( &node->state, NODE_LEAF, __ATOMIC_RELEASE );
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief       Selects a child node by UCB1.
+ *
+ * Returns the child with the highest upper confidence bound of its winning
+ * rate. An unvisited child is valued by its AMAF winning rate if there is
+ * one and by MCTS_FPU otherwise (first play urgency), plus the exploration
+ * term of one visit.
+ *
+ * With RAVE the winning rate is blended with the AMAF winning rate. The
+ * weight of the AMAF value is sqrt( k / ( 3n + k ) ), k = MCTS_RAVE_EQUIV,
+ * so it dominates for few visits n and fades out as the visits grow.
+ *
+ * @param[in]   node    Expanded node with children
+ * @return      Selected child
+ */
+mcts_node_t *select_child( mcts_node_t *node )
+{
+    int k;
+    unsigned int visits;
+    unsigned int wins;
+    unsigned int amaf_visits;
+    double value;
+    double beta;
+    double amaf_value;
+    double best_value = -1.0;
+    double bias;
+    double log_visits = log( (double)( __atomic_load_n( &node->visits, __ATOMIC_RELAXED ) + 1 ) );
+    int    width      = MCTS_WIDEN_MIN;
+    mcts_node_t *child;
+    mcts_node_t *best = get_children(node);
+
+    // Progressive widening, one more child every time the visits grow by
+    // MCTS_WIDEN_FACTOR:
+    if ( log_visits >= log(MCTS_WIDEN_VISITS) ) {
+        width += 1 + (int)( ( log_visits - log(MCTS_WIDEN_VISITS) ) / log(MCTS_WIDEN_FACTOR) );
+    }
+    if ( width > node->nr_of_children ) {
+        width = node->nr_of_children;
+    }
+
+    for ( k = 0; k < width; k++ ) {
+        child       = &get_children(node)[k];
+        visits      = __atomic_load_n( &child->visits,      __ATOMIC_RELAXED );
+        wins        = __atomic_load_n( &child->wins,        __ATOMIC_RELAXED );
+        amaf_visits = __atomic_load_n( &child->amaf_visits, __ATOMIC_RELAXED );
+
+        if ( visits == 0 ) {
+            // First play urgency: the AMAF value if there is one, MCTS_FPU
+            // otherwise. Equal values in random order:
+            value = MCTS_FPU;
+            if ( use_rave && amaf_visits > 0 ) {
+                value = (double)__atomic_load_n( &child->amaf_wins, __ATOMIC_RELAXED ) / amaf_visits;
+            }
+            value += ( use_rave ? MCTS_RAVE_UCT_C : MCTS_UCT_C ) * sqrt(log_visits)
+                   + ( get_playout_random() % 100 ) / 100000.0;
+        }
+        else if ( use_rave && amaf_visits > 0 ) {
+            amaf_value = (double)__atomic_load_n( &child->amaf_wins, __ATOMIC_RELAXED ) / amaf_visits;
+            beta       = sqrt( MCTS_RAVE_EQUIV / ( 3.0 * visits + MCTS_RAVE_EQUIV ) );
+            value      = ( 1.0 - beta ) * wins / visits
+                       + beta * amaf_value
+                       + MCTS_RAVE_UCT_C * sqrt( log_visits / visits );
+        }
+        else {
+            value = (double)wins / visits
+                  + MCTS_UCT_C * sqrt( log_visits / visits );
+        }
+
+        // Bonus of the prior, fading with the visits:
+        bias   = MCTS_PRIOR_BIAS * child->prior / ( (double)PRIOR_ONE * ( visits + 1 ) );
+        value += bias;
+
+        if ( value > best_value ) {
+            best_value = value;
+            best       = child;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief       Returns the coordinates of a move.
+ *
+ * @param[in]   vertex  Index of move on playout board
+ * @param[out]  i       Horizontal coordinate
+ * @param[out]  j       Vertical coordinate
+ * @return      Nothing
+ */
+void get_move( int vertex, int *i, int *j )
+{
+    int width = get_board_size() + 2;
+
+    *i = vertex % width - 1;
+    *j = vertex / width - 1;
+
+    return;
+}
+
+/**
+ * @brief       Helper function for qsort() to sort moves by prior.
+ *
+ * @param[in]   move1   Pointer to first move (vertex, prior)
+ * @param[in]   move2   Pointer to second move (vertex, prior)
+ * @return      1|0|-1
+ */
+int compare_prior( const void *move1, const void *move2 )
+{
+    if ( ((int *)move1)[1] > ((int *)move2)[1] ) {
+        return -1;
+    }
+    else if ( ((int *)move1)[1] < ((int *)move2)[1] ) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       Updates the AMAF statistics of the children of a node.
+ *
+ * Every child whose move was played first by its color later in the
+ * simulation counts the simulation as if the move had been played at once
+ * (All Moves As First).
+ *
+ * @param[in,out] node      Expanded node on the path of the simulation
+ * @param[in]   amaf_color  First color played per vertex after the node
+ * @param[in]   winner      Winner of the simulation
+ * @return      Nothing
+ */
+void update_amaf( mcts_node_t *node, const signed char amaf_color[], int winner )
+{
+    int k;
+    mcts_node_t *child;
+
+    for ( k = 0; k < node->nr_of_children; k++ ) {
+        child = &get_children(node)[k];
+        if ( amaf_color[ child->vertex ] == child->color ) {
+            __atomic_fetch_add( &child->amaf_visits, 1, __ATOMIC_RELAXED );
+            if ( child->color == winner ) {
+                __atomic_fetch_add( &child->amaf_wins, 1, __ATOMIC_RELAXED );
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief       Sets number of playouts.
+ *
+ * Sets the number of playouts of a Monte Carlo tree search.
+ *
+ * @param[in]   count   Number of playouts
+ * @return      Nothing
+ */
+void set_playouts( int count )
+{
+
+    playouts = count;
+
+    return;
+}
+
+/**
+ * @brief       Returns number of playouts.
+ *
+ * Returns the number of playouts of a Monte Carlo tree search.
+ *
+ * @return      Number of playouts
+ */
+int get_playouts(void)
+{
+
+    return playouts;
+}
+
+/**
+ * @brief       Switches RAVE on or off.
+ *
+ * Switches the use of AMAF values for node selection on or off.
+ *
+ * @param[in]   is_on   true|false
+ * @return      Nothing
+ */
+void set_rave( bool is_on )
+{
+
+    use_rave = is_on;
+
+    return;
+}
+
+/**
+ * @brief       Returns if RAVE is used.
+ *
+ * @return      true|false
+ */
+bool get_rave(void)
+{
+
+    return use_rave;
+}
+
+/**
+ * @brief       Sets the memory limit of the search tree.
+ *
+ * The node pool is allocated again with the new size, the kept tree is
+ * dropped.
+ *
+ * @param[in]   megabytes   Memory limit in MB
+ * @return      Nothing
+ */
+void set_tree_memory( int megabytes )
+{
+
+    free_node_pool();
+    tree_memory = megabytes;
+
+    return;
+}
+
+/**
+ * @brief       Returns the memory limit of the search tree.
+ *
+ * @return      Memory limit in MB
+ */
+int get_tree_memory(void)
+{
+
+    return tree_memory;
+}
+
+/**
+ * @brief       Returns the number of nodes of the kept search tree.
+ *
+ * @return      Number of nodes taken from the pool
+ */
+unsigned int get_tree_nodes(void)
+{
+
+    return pool_used;
+}
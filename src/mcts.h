@@ -0,0 +1,33 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+/**
+ * @file    mcts.h
+ *
+ * @brief   Interface definition for mcts.c
+ *
+ */
+
+#include <stdbool.h>
+
+void mcts_search( int color, float komi, int *i, int *j );
+void mcts_play_move( int color, int i, int j );
+void free_search_tree(void);
+void free_node_pool(void);
+
+void start_pondering( int color, float komi );
+void stop_pondering(void);
+bool is_pondering(void);
+
+void set_playouts( int count );
+int  get_playouts(void);
+
+void set_rave( bool is_on );
+bool get_rave(void);
+
+void         set_tree_memory( int megabytes );
+int          get_tree_memory(void);
+unsigned int get_tree_nodes(void);
+
+#endif
+
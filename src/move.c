@@ -18,10 +18,28 @@
  */
 
 //! The number of the latest move.
-static int move_number = 0;
+static __thread int move_number = 0;
 
-//! Move history: contains all moves performed.
-static move_t move_history[MOVE_HISTORY_MAX];
+//! Move history of the main thread.
+static move_t main_move_history[MOVE_HISTORY_MAX];
+
+//! Move history: contains all moves performed. Search threads allocate their
+//! own history in set_move_history_base(), so their thread local data is small.
+static __thread move_t *move_history = main_move_history;
+
+//! Move stack: the move lists of a search are carved from this memory.
+static __thread int (*move_stack)[4] = NULL;
+//! Index of the first free entry of the move stack.
+static __thread int move_stack_top = 0;
+//! Child positions of get_valid_move_list() for batch evaluation.
+static __thread board_snapshot_t *leaf_snapshots = NULL;
+//! Values of the child positions of get_valid_move_list().
+static __thread int *leaf_values = NULL;
+
+//! Structure to store next move in move history.
+__thread move_t next_move;
+
+static int compare_tactic( const void *move1, const void *move2 );
 
 
 
@@ -58,6 +76,25 @@ void init_move_history(void)
     return;
 };
 
+/**
+ * @brief       Frees the move history of a search thread.
+ *
+ * Frees the memory allocated by set_move_history_base(). The move history
+ * of the main thread is not touched.
+ *
+ * @return      Nothing
+ * @sa          set_move_history_base()
+ */
+void free_move_history(void)
+{
+    if ( move_history != main_move_history ) {
+        free(move_history);
+        move_history = main_move_history;
+    }
+
+    return;
+}
+
 /**
  * @brief       Creates a move structure with default values.
  *
@@ -139,6 +176,24 @@ void set_move_captured_stones( int captured_stones[][2] )
     return;
 }
 
+/**
+ * @brief       Sets the stones captured on the board as captured stones.
+ *
+ * The stones removed by the last call of remove_stones() are stored as
+ * captured stones in next_move. This is the same as calling
+ * set_move_captured_stones() with the list of get_captured_now(), but
+ * without an extra copy of the list.
+ *
+ * @return      Number of captured stones
+ * @sa          get_captured_now()
+ */
+int set_move_captured_now(void)
+{
+    next_move.count_stones = get_captured_now( next_move.stones );
+
+    return next_move.count_stones;
+}
+
 /**
  * @brief       Sets the ko field.
  *
@@ -342,15 +397,21 @@ bool is_move_ko( int color, int i, int j )
  * include those moves which leave the setting stone without liberties. Ko
  * moves are not included in this list.
  *
- * @param[in]   color       Current color to move
- * @param[out]  valid_moves List of pseudo valid moves (Ko moves excluded)
+ * Moves in pass-alive territory of either color cannot change the result.
+ * They are dropped if skip_pass_alive is set. This needs Benson's algorithm
+ * for every new position (see get_pass_alive()), which takes a few
+ * microseconds, so it is meant for the root of a search only.
+ *
+ * @param[in]   color           Current color to move
+ * @param[out]  valid_moves     List of pseudo valid moves (Ko moves excluded)
+ * @param[in]   skip_pass_alive Drop moves in pass-alive territory
  * @return      Number of pseudo valid moves
  * @note        This list does not contain invalid ko moves, those are dropped
  *              from this list. But moves that leave the stone or group
- *              without a liberty are still contained in this list. Therefore
- *              the term "pseudo valid".
+ *              without a liberty are still contained in this list.
+ *              Therefore the term "pseudo valid".
  */
-int get_pseudo_valid_move_list( int color, int valid_moves[][4] )
+int get_pseudo_valid_move_list( int color, int valid_moves[][4], bool skip_pass_alive )
 {
     int count;
     int i, j;
@@ -359,7 +420,8 @@ int get_pseudo_valid_move_list( int color, int valid_moves[][4] )
     count = 0;
     for ( i = 0; i < board_size; i++ ) {
         for ( j = 0; j < board_size; j++ ) {
-            if ( get_vertex( i, j ) == EMPTY && ! is_move_ko( color, i, j ) ) {
+            if ( get_vertex( i, j ) == EMPTY && ! is_move_ko( color, i, j )
+                    && ! ( skip_pass_alive && get_pass_alive( i, j ) != EMPTY ) ) {
                 valid_moves[count][0] = i;
                 valid_moves[count][1] = j;
                 valid_moves[count][2] = 0;
@@ -381,28 +443,33 @@ int get_pseudo_valid_move_list( int color, int valid_moves[][4] )
  *
  * This function takes a list of pseudo valid moves (as created by
  * get_pseudo_valid_move_list()) and drops the zero liberty moves. The
- * number of valid moves is returned.
+ * number of valid moves is returned. Vital points of unsettled eye shapes
+ * (see is_eye_vital_point()) count as tactical moves. If
+ * is_batch_evaluation() is true, the positions after the valid moves are
+ * evaluated together by evaluate_positions().
  *
  * @param[in]   color               Color of moving side (BLACK|WHITE)
  * @param[out]  valid_moves         List of valid moves (zero liberty moves excluded)
+ * @param[in]   skip_pass_alive     Drop moves in pass-alive territory (search root only)
  * @return      Number of valid moves
  * @sa          get_pseudo_valid_move_list()
  * @warning     The function get_pseudo_valid_move_list() must be called
  *              before get_valid_move_list().
  */
-int get_valid_move_list( int color, int valid_moves[][4] )
+int get_valid_move_list( int color, int valid_moves[][4], bool skip_pass_alive )
 {
     int  count;
     int  i, j;
-    int  k, l;
+    int  k;
     int  nr_of_removed_stones;
-    int  captured_now[BOARD_SIZE_MAX * BOARD_SIZE_MAX][2];
     int  group_nr;
     int  nr_of_liberties;
     bool is_valid;
-    int  temp_moves[BOARD_SIZE_MAX * BOARD_SIZE_MAX][4];
     int  value;
+    int  tactic;
     int  valid_moves_count;
+    int  count_leaves;
+    bool is_batch;
     int  atari_groups_player_before;
     int  atari_groups_opponent_before;
     int  atari_groups_player_after;
@@ -416,18 +483,31 @@ int get_valid_move_list( int color, int valid_moves[][4] )
 
     //init_brains();
 
-    valid_moves_count = get_pseudo_valid_move_list( color, valid_moves );
-
-    for ( k = 0; k < BOARD_SIZE_MAX * BOARD_SIZE_MAX; k++ ) {
-        temp_moves[k][0] = INVALID;     // i coordinate
-        temp_moves[k][1] = INVALID;     // j coordinate
-        temp_moves[k][2] = 0;           // Value of move
-        temp_moves[k][3] = 0;           // Number of captured stones and atari ...
+    // Pass-alive territory is found on the worm data:
+    if ( skip_pass_alive ) {
+        scan_board_1();
     }
+    valid_moves_count = get_pseudo_valid_move_list( color, valid_moves, skip_pass_alive );
+
+    // If the brains read the stones without the board, the children are
+    // evaluated in one batch:
+    is_batch = is_batch_evaluation();
+    if ( is_batch && leaf_snapshots == NULL ) {
+        leaf_snapshots = malloc( BOARD_SIZE_MAX * BOARD_SIZE_MAX * sizeof(board_snapshot_t) );
+        leaf_values    = malloc( BOARD_SIZE_MAX * BOARD_SIZE_MAX * sizeof(int) );
+        if ( leaf_snapshots == NULL || leaf_values == NULL ) {
+            fprintf( stderr, "cannot allocate memory for leaf snapshots\n" );
+            exit(EXIT_FAILURE);
+        }
+    }
+    count_leaves = 0;
 
+    // The valid moves are compacted in place; entry k is read before any
+    // entry up to k is written.
     count = 0;
     for ( k = 0; k < valid_moves_count; k++ ) {
         is_valid = false;
+        tactic   = 0;
         i = valid_moves[k][0];
         j = valid_moves[k][1];
 
@@ -435,6 +515,10 @@ int get_valid_move_list( int color, int valid_moves[][4] )
         scan_board_1();
         atari_groups_player_before      = get_worm_count_atari(color);
         atari_groups_opponent_before    = get_worm_count_atari( color * -1 );
+        // Check if move is the vital point of an eye shape:
+        if ( is_eye_vital_point( color, i, j ) ) {
+            tactic++;
+        }
         //count_liberties_player_before   = get_group_count_liberties(color);
         //count_liberties_opponent_before = get_group_count_liberties( color * -1 );
 
@@ -443,6 +527,11 @@ int get_valid_move_list( int color, int valid_moves[][4] )
         scan_board_1();
         nr_of_removed_stones = remove_stones( color * -1 );
 
+        // The atari counts and the evaluation need the worms after captures:
+        if ( nr_of_removed_stones > 0 ) {
+            scan_board_1();
+        }
+
         // Check if this move is valid:
         if ( nr_of_removed_stones > 0 ) {
             is_valid = true;
@@ -459,56 +548,54 @@ int get_valid_move_list( int color, int valid_moves[][4] )
         atari_groups_opponent_after = get_worm_count_atari( color * -1 );
         // Check if move gives atari:
         if ( atari_groups_opponent_after > atari_groups_opponent_before ) {
-            temp_moves[k][3]++;
+            tactic++;
         }
         // Check if move avoids atari:
         if ( atari_groups_player_after < atari_groups_player_before ) {
-            temp_moves[k][3]++;
+            tactic++;
         }
 
         //count_liberties_player_after   = get_group_count_liberties(color);
         /*
         count_liberties_opponent_after = get_group_count_liberties( color * -1 );
         if ( count_liberties_opponent_after < count_liberties_opponent_before) {
-            temp_moves[k][3]++;
+            tactic++;
         }
         */
 
-        value = evaluate_position( value_list, false );
+        value = 0;
+        if ( ! is_batch ) {
+            value = evaluate_position(value_list);
+        }
+        else if ( is_valid ) {
+            // The n-th snapshot belongs to the n-th kept move:
+            get_board_snapshot( &leaf_snapshots[count_leaves] );
+            count_leaves++;
+        }
 
         // Undo move:
-        nr_of_removed_stones = get_captured_now(captured_now);
         set_vertex( EMPTY, i, j );
-        for ( l = 0; l < nr_of_removed_stones; l++ ) {
-            set_vertex( color * -1, captured_now[l][0], captured_now[l][1] );
-        }
-        if ( color == BLACK ) {
-            set_black_captured( get_black_captured() - nr_of_removed_stones );
-        }
-        else {
-            set_white_captured( get_white_captured() - nr_of_removed_stones );
-        }
+        restore_stones( color * -1 );
 
-        // Save only valid moves in temporary list:
+        // Keep only valid moves in list:
         if ( is_valid ) {
-            temp_moves[count][0] = i;
-            temp_moves[count][1] = j;
-            temp_moves[count][2] = value;
-            temp_moves[count][3] += nr_of_removed_stones;
+            valid_moves[count][0] = i;
+            valid_moves[count][1] = j;
+            valid_moves[count][2] = value;
+            valid_moves[count][3] = tactic + nr_of_removed_stones;
             count++;
         }
     }
-
-    // Copy only valid moves into valid_moves list:
-    for ( k = 0; k < count; k++ ) {
-        valid_moves[k][0] = temp_moves[k][0];
-        valid_moves[k][1] = temp_moves[k][1];
-        valid_moves[k][2] = temp_moves[k][2];
-        valid_moves[k][3] = temp_moves[k][3];
-    }
     valid_moves[count][0] = INVALID;
     valid_moves[count][1] = INVALID;
 
+    if ( is_batch && count_leaves > 0 ) {
+        evaluate_positions( leaf_snapshots, count_leaves, leaf_values );
+        for ( k = 0; k < count_leaves; k++ ) {
+            valid_moves[k][2] = leaf_values[k];
+        }
+    }
+
     // Sort valid moves list by value
     if ( color == BLACK ) {
         qsort( valid_moves, (size_t)count, sizeof(valid_moves[0]), compare_value_black );
@@ -520,6 +607,94 @@ int get_valid_move_list( int color, int valid_moves[][4] )
     return count;
 }
 
+/**
+ * @brief       Creates a list of tactical moves for a given color.
+ *
+ * Only captures, atari escapes and ataris are generated. They are taken
+ * directly from the liberties of the worms in atari and of the opponent
+ * worms with two liberties, so no move has to be tried on the board. The
+ * tactic field of a move counts the stones it captures plus one for each
+ * escape or atari. The list is sorted by this field, biggest first.
+ *
+ * @param[in]   color           Color of moving side (BLACK|WHITE)
+ * @param[out]  tactical_moves  List of tactical moves
+ * @return      Number of tactical moves
+ * @sa          get_valid_move_list()
+ * @note        The worm data must be up to date, i.e. scan_board_1() must
+ *              have been called after the last change of the board.
+ */
+int get_tactical_move_list( int color, int tactical_moves[][4] )
+{
+    int k, l;
+    int i, j;
+    int count = 0;
+    int nr_of_liberties;
+    int liberties[BOARD_SIZE_MAX * BOARD_SIZE_MAX][3];
+    int kind;
+
+    // kind 0: captures, kind 1: atari escapes, kind 2: ataris
+    for ( kind = 0; kind < 3; kind++ ) {
+        if ( kind == 0 ) {
+            nr_of_liberties = get_worm_liberties( color * -1, 1, liberties );
+        }
+        else if ( kind == 1 ) {
+            nr_of_liberties = get_worm_liberties( color, 1, liberties );
+        }
+        else {
+            nr_of_liberties = get_worm_liberties( color * -1, 2, liberties );
+        }
+
+        for ( k = 0; k < nr_of_liberties; k++ ) {
+            i = liberties[k][0];
+            j = liberties[k][1];
+
+            for ( l = 0; l < count; l++ ) {
+                if ( tactical_moves[l][0] == i && tactical_moves[l][1] == j ) {
+                    break;
+                }
+            }
+            if ( l == count ) {
+                if ( ! is_legal_move( color, i, j ) || is_move_ko( color, i, j ) ) {
+                    continue;
+                }
+                tactical_moves[count][0] = i;
+                tactical_moves[count][1] = j;
+                tactical_moves[count][2] = 0;
+                tactical_moves[count][3] = 0;
+                count++;
+            }
+
+            tactical_moves[l][3] += ( kind == 0 ) ? liberties[k][2] : 1;
+        }
+    }
+    tactical_moves[count][0] = INVALID;
+    tactical_moves[count][1] = INVALID;
+    tactical_moves[count][2] = 0;
+    tactical_moves[count][3] = 0;
+
+    qsort( tactical_moves, (size_t)count, sizeof(tactical_moves[0]), compare_tactic );
+
+    return count;
+}
+
+/**
+ * @brief       Compares the tactic field of two moves.
+ *
+ * Compare function for qsort(). Moves with a bigger tactic field are sorted
+ * to the front.
+ *
+ * @param[in]   move1   First move
+ * @param[in]   move2   Second move
+ * @return      Negative, zero or positive value
+ */
+static int compare_tactic( const void *move1, const void *move2 )
+{
+    const int *m1 = move1;
+    const int *m2 = move2;
+
+    return m2[3] - m1[3];
+}
+
 /**
  * @brief       Return color of last move.
  *
@@ -616,6 +791,25 @@ void get_last_move_stones( int stones[][2] )
     return;
 }
 
+/**
+ * @brief       Returns one captured stone of last move.
+ *
+ * Returns the coordinates of the captured stone with the given number of the
+ * last move.
+ *
+ * @param[in]   k       Number of stone, from zero to get_last_move_count_stones() - 1
+ * @param[out]  stone   Coordinates (i, j) of stone
+ * @return      Nothing
+ * @sa          get_last_move_stones()
+ */
+void get_last_move_stone( int k, int stone[2] )
+{
+    stone[0] = move_history[move_number].stones[k][0];
+    stone[1] = move_history[move_number].stones[k][1];
+
+    return;
+}
+
 /**
  * @brief       Returns value of move.
  *
@@ -629,3 +823,137 @@ int get_last_move_value(void)
     return move_history[move_number].value;
 }
 
+/**
+ * @brief       Returns copy of last move.
+ *
+ * Copies the complete data structure of the last move in the move history.
+ *
+ * @param[out]  move    Copy of last move
+ * @return      Nothing
+ * @sa          set_move_history_base()
+ */
+void get_last_move( move_t *move )
+{
+    *move = move_history[move_number];
+
+    return;
+}
+
+/**
+ * @brief       Starts a new move history with the given move.
+ *
+ * Allocates and initialises a move history for the calling thread and pushes
+ * the given move, so ko information of the position is known. This is used
+ * by search threads that work on a copy of the position.
+ *
+ * @param[in]   move    Move as returned by get_last_move()
+ * @return      Nothing
+ * @sa          get_last_move(), free_move_history()
+ */
+void set_move_history_base( const move_t *move )
+{
+    if ( move_history == main_move_history ) {
+        move_history = malloc( MOVE_HISTORY_MAX * sizeof(move_t) );
+        if ( move_history == NULL ) {
+            fprintf( stderr, "cannot allocate memory for move history\n" );
+            exit(EXIT_FAILURE);
+        }
+    }
+    init_move_history();
+
+    if ( move->number == INVALID ) {
+        return;
+    }
+
+    next_move = *move;
+    push_move();
+
+    return;
+}
+
+/**
+ * @brief       Returns memory for a new move list.
+ *
+ * Returns a pointer to the free part of the move stack of the calling
+ * thread. There is room for the moves of a whole board and the terminating
+ * entry. The list must be closed with close_move_list() after it has been
+ * filled, so the next list is placed behind it. The move stack is allocated
+ * with the first call.
+ *
+ * @return      Pointer to move list
+ * @sa          close_move_list(), free_move_list()
+ */
+int (*open_move_list(void))[4]
+{
+    int board_size = get_board_size();
+
+    if ( move_stack == NULL ) {
+        move_stack = malloc( MOVE_STACK_SIZE * sizeof(move_stack[0]) );
+        if ( move_stack == NULL ) {
+            fprintf( stderr, "cannot allocate memory for move stack\n" );
+            exit(EXIT_FAILURE);
+        }
+        move_stack_top = 0;
+    }
+
+    if ( move_stack_top + board_size * board_size + 1 > MOVE_STACK_SIZE ) {
+        fprintf( stderr, "Move lists have exceeded MOVE_STACK_SIZE\n" );
+        exit(EXIT_FAILURE);
+    }
+
+    return &move_stack[move_stack_top];
+}
+
+/**
+ * @brief       Closes the move list opened last.
+ *
+ * Reserves the number of moves plus the terminating entry for the list
+ * returned by open_move_list().
+ *
+ * @param[in]   count   Number of moves in list
+ * @return      Nothing
+ * @sa          open_move_list()
+ */
+void close_move_list( int count )
+{
+    move_stack_top += count + 1;
+
+    return;
+}
+
+/**
+ * @brief       Gives a move list back to the move stack.
+ *
+ * The given list and all lists opened after it are freed.
+ *
+ * @param[in]   move_list   List returned by open_move_list()
+ * @return      Nothing
+ * @sa          open_move_list()
+ */
+void free_move_list( int move_list[][4] )
+{
+    move_stack_top = (int)( move_list - move_stack );
+
+    return;
+}
+
+/**
+ * @brief       Frees the move stack.
+ *
+ * Frees the move stack and the leaf buffers of the calling thread.
+ *
+ * @return      Nothing
+ * @sa          open_move_list()
+ */
+void free_move_stack(void)
+{
+    free(move_stack);
+    move_stack     = NULL;
+    move_stack_top = 0;
+    free(leaf_snapshots);
+    leaf_snapshots = NULL;
+    free(leaf_values);
+    leaf_values    = NULL;
+
+    return;
+}
@@ -27,13 +27,15 @@ typedef struct {
     int  value;         //!< Value of move will be stored here
 } move_t;
 
-move_t next_move;    //!< Structure to store next move in move history.
+extern __thread move_t next_move;   //!< Structure to store next move in move history.
 
 
 void init_move_history(void);
+void free_move_history(void);
 void create_next_move(void);
 void set_move_vertex( int color, int i, int j );
 void set_move_captured_stones( int captured_stones[][2] );
+int  set_move_captured_now(void);
 void push_move(void);
 void pop_move(void);
 void set_move_ko( int i, int j );
@@ -43,8 +45,9 @@ int  get_move_last_ko_j(void);
 int  get_move_last_color(void);
 
 bool is_move_ko( int color, int i, int j );
-int  get_pseudo_valid_move_list( int color, int valid_moves[][4] );
-int  get_valid_move_list( int color, int valid_moves[][4] );
+int  get_pseudo_valid_move_list( int color, int valid_moves[][4], bool skip_pass_alive );
+int  get_valid_move_list( int color, int valid_moves[][4], bool skip_pass_alive );
+int  get_tactical_move_list( int color, int tactical_moves[][4] );
 
 int  get_move_number(void);
 int  get_last_move_number(void);
@@ -54,6 +57,14 @@ int  get_last_move_j(void);
 bool get_last_move_pass(void);
 int  get_last_move_count_stones(void);
 void get_last_move_stones( int stones[][2] );
+void get_last_move_stone( int k, int stone[2] );
 int  get_last_move_value(void);
+void get_last_move( move_t *move );
+void set_move_history_base( const move_t *move );
+
+int  (*open_move_list(void))[4];
+void close_move_list( int count );
+void free_move_list( int move_list[][4] );
+void free_move_stack(void);
 
 #endif
@@ -0,0 +1,311 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "global_const.h"
+#include "board.h"
+#include "network.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+/**
+ * @file    network.c
+ *
+ * @brief   Small neural network that evaluates a position.
+ *
+ * The input of the network are two planes of the board, one for black and
+ * one for white stones. The first layer has NETWORK_HIDDEN neurons, its
+ * output is clipped to 0 .. NETWORK_CLIP and combined to one value by the
+ * output layer. The value is positive for black, like all brains.
+ *
+ * The first layer is not computed for every evaluation: the accumulator
+ * holds the sums of the first layer for the current position and is
+ * updated by the board for every stone that is set, captured or put back
+ * (see update_eval_data() in board.c). So an evaluation only costs the
+ * output layer. The accumulator exists per thread, the weights are shared.
+ *
+ * The weights are loaded from a file with the byte order of the machine:
+ *
+ * - char[4] "HGNN"
+ * - int32 board size the network has been trained for
+ * - int32 number of neurons of the first layer, must be NETWORK_HIDDEN
+ * - int16 bias of the first layer per neuron
+ * - int16 weight per input and neuron, the inputs are the black plane and
+ *   then the white plane, each plane row by row (index j * size + i)
+ * - int8 weight of the output layer per neuron
+ * - int32 bias of the output layer
+ *
+ * The network gives zero for other board sizes. With AVX2 the vector
+ * kernels are used, otherwise portable loops.
+ *
+ */
+
+static int   network_size = 0;                      //!< Board size of the loaded network or 0.
+static short input_bias[NETWORK_HIDDEN];            //!< Bias of the first layer.
+static short input_weight[NETWORK_INPUTS][NETWORK_HIDDEN] __attribute__ (( aligned(32) ));  //!< Weights of the first layer.
+static short output_weight[NETWORK_HIDDEN] __attribute__ (( aligned(32) ));                 //!< Weights of the output layer, widened to 16 bit.
+static int   output_bias;                           //!< Bias of the output layer.
+
+static __thread short accumulator[NETWORK_HIDDEN] __attribute__ (( aligned(32) ));  //!< First layer of the current position.
+
+static int  get_input( int i, int j, int color );
+static void add_weights( const short weight[] );
+static void sub_weights( const short weight[] );
+
+
+/**
+ * @brief       Loads the weights of a network from a file.
+ *
+ * The accumulator of the calling thread is computed for the current
+ * position. If the file cannot be read or has the wrong format, no network
+ * is loaded afterwards.
+ *
+ * @param[in]   filename    Name of network file
+ * @return      true if the network has been loaded
+ */
+bool load_network( const char *filename )
+{
+    FILE *file;
+    char magic[4];
+    int32_t size;
+    int32_t hidden;
+    int8_t  weight[NETWORK_HIDDEN];
+    int32_t bias;
+    int k;
+    bool is_ok;
+
+    network_size = 0;
+
+    file = fopen( filename, "rb" );
+    if ( file == NULL ) {
+        return false;
+    }
+
+    is_ok = fread( magic, 1, 4, file ) == 4 && memcmp( magic, "HGNN", 4 ) == 0
+        && fread( &size, sizeof(size), 1, file ) == 1
+        && size >= BOARD_SIZE_MIN && size <= BOARD_SIZE_MAX
+        && fread( &hidden, sizeof(hidden), 1, file ) == 1 && hidden == NETWORK_HIDDEN
+        && fread( input_bias, sizeof(short), NETWORK_HIDDEN, file ) == NETWORK_HIDDEN;
+
+    for ( k = 0; is_ok && k < 2 * size * size; k++ ) {
+        is_ok = fread( input_weight[k], sizeof(short), NETWORK_HIDDEN, file ) == NETWORK_HIDDEN;
+    }
+
+    is_ok = is_ok
+        && fread( weight, sizeof(int8_t), NETWORK_HIDDEN, file ) == NETWORK_HIDDEN
+        && fread( &bias, sizeof(bias), 1, file ) == 1
+        && fgetc(file) == EOF;
+
+    fclose(file);
+
+    if ( ! is_ok ) {
+        return false;
+    }
+
+    for ( k = 0; k < NETWORK_HIDDEN; k++ ) {
+        output_weight[k] = weight[k];
+    }
+    output_bias  = bias;
+    network_size = size;
+
+    refresh_network();
+
+    return true;
+}
+
+/**
+ * @brief       Unloads the network.
+ *
+ * @return      Nothing
+ */
+void unload_network(void)
+{
+    network_size = 0;
+
+    return;
+}
+
+/**
+ * @brief       Checks if a network is loaded.
+ *
+ * @return      true if a network is loaded
+ */
+bool is_network_loaded(void)
+{
+
+    return network_size != 0;
+}
+
+/**
+ * @brief       Computes the accumulator for the current position.
+ *
+ * Must be called by every thread whenever the board is set up without
+ * update_network(), e.g. by init_board().
+ *
+ * @return      Nothing
+ */
+void refresh_network(void)
+{
+    int i, j;
+    int color;
+
+    if ( network_size == 0 || network_size != get_board_size() ) {
+        return;
+    }
+
+    memcpy( accumulator, input_bias, sizeof(accumulator) );
+    for ( i = 0; i < network_size; i++ ) {
+        for ( j = 0; j < network_size; j++ ) {
+            color = get_vertex( i, j );
+            if ( color != EMPTY ) {
+                add_weights( input_weight[ get_input( i, j, color ) ] );
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief       Updates the accumulator for a changed vertex.
+ *
+ * @param[in]   i           Horizontal coordinate
+ * @param[in]   j           Vertical coordinate
+ * @param[in]   old_color   Color before the change
+ * @param[in]   new_color   Color after the change
+ * @return      Nothing
+ */
+void update_network( int i, int j, int old_color, int new_color )
+{
+
+    if ( network_size == 0 || network_size != get_board_size() ) {
+        return;
+    }
+
+    if ( old_color != EMPTY ) {
+        sub_weights( input_weight[ get_input( i, j, old_color ) ] );
+    }
+    if ( new_color != EMPTY ) {
+        add_weights( input_weight[ get_input( i, j, new_color ) ] );
+    }
+
+    return;
+}
+
+/**
+ * @brief       Returns the value of the network for the current position.
+ *
+ * @return      Value of position, zero if no network for this board size
+ */
+int get_network_value(void)
+{
+    int value = 0;
+
+    if ( network_size == 0 || network_size != get_board_size() ) {
+        return 0;
+    }
+
+#ifdef __AVX2__
+    int k;
+    __m256i zero = _mm256_setzero_si256();
+    __m256i clip = _mm256_set1_epi16(NETWORK_CLIP);
+    __m256i sum  = zero;
+    __m256i x;
+    __m128i s;
+
+    for ( k = 0; k < NETWORK_HIDDEN; k += 16 ) {
+        x   = _mm256_load_si256( (const __m256i *)&accumulator[k] );
+        x   = _mm256_min_epi16( _mm256_max_epi16( x, zero ), clip );
+        sum = _mm256_add_epi32( sum, _mm256_madd_epi16( x, _mm256_load_si256( (const __m256i *)&output_weight[k] ) ) );
+    }
+    s = _mm_add_epi32( _mm256_castsi256_si128(sum), _mm256_extracti128_si256( sum, 1 ) );
+    s = _mm_hadd_epi32( s, s );
+    s = _mm_hadd_epi32( s, s );
+    value = _mm_cvtsi128_si32(s);
+#else
+    int k;
+    int x;
+
+    for ( k = 0; k < NETWORK_HIDDEN; k++ ) {
+        x = accumulator[k];
+        if ( x < 0 ) {
+            x = 0;
+        }
+        else if ( x > NETWORK_CLIP ) {
+            x = NETWORK_CLIP;
+        }
+        value += x * output_weight[k];
+    }
+#endif
+
+    return ( value + output_bias ) / ( 1 << NETWORK_SHIFT );
+}
+
+/**
+ * @brief       Returns the input index of a stone.
+ *
+ * @param[in]   i       Horizontal coordinate
+ * @param[in]   j       Vertical coordinate
+ * @param[in]   color   BLACK|WHITE
+ * @return      Index of input
+ */
+int get_input( int i, int j, int color )
+{
+    int plane = ( color == BLACK ) ? 0 : 1;
+
+    return ( plane * network_size + j ) * network_size + i;
+}
+
+/**
+ * @brief       Adds the weights of an input to the accumulator.
+ *
+ * @param[in]   weight  Weights of input
+ * @return      Nothing
+ */
+void add_weights( const short weight[] )
+{
+    int k;
+
+#ifdef __AVX2__
+    __m256i *acc = (__m256i *)accumulator;
+    const __m256i *w = (const __m256i *)weight;
+
+    for ( k = 0; k < NETWORK_HIDDEN / 16; k++ ) {
+        acc[k] = _mm256_add_epi16( acc[k], w[k] );
+    }
+#else
+    for ( k = 0; k < NETWORK_HIDDEN; k++ ) {
+        accumulator[k] += weight[k];
+    }
+#endif
+
+    return;
+}
+
+/**
+ * @brief       Subtracts the weights of an input from the accumulator.
+ *
+ * @param[in]   weight  Weights of input
+ * @return      Nothing
+ */
+void sub_weights( const short weight[] )
+{
+    int k;
+
+#ifdef __AVX2__
+    __m256i *acc = (__m256i *)accumulator;
+    const __m256i *w = (const __m256i *)weight;
+
+    for ( k = 0; k < NETWORK_HIDDEN / 16; k++ ) {
+        acc[k] = _mm256_sub_epi16( acc[k], w[k] );
+    }
+#else
+    for ( k = 0; k < NETWORK_HIDDEN; k++ ) {
+        accumulator[k] -= weight[k];
+    }
+#endif
+
+    return;
+}
@@ -0,0 +1,27 @@
+#ifndef NETWORK_H
+#define NETWORK_H
+
+/**
+ * @file    network.h
+ *
+ * @brief   Interface definition for network.c
+ *
+ */
+
+#include <stdbool.h>
+#include "global_const.h"
+
+#define NETWORK_HIDDEN      32      //!< Number of neurons of the first layer, a multiple of 16.
+#define NETWORK_INPUTS      ( 2 * BOARD_SIZE_MAX * BOARD_SIZE_MAX ) //!< Maximum number of inputs, one plane per color.
+#define NETWORK_CLIP        127     //!< Upper limit of the clipped ReLU of the first layer.
+#define NETWORK_SHIFT       6       //!< Output of the network is divided by 2 ^ NETWORK_SHIFT.
+
+bool load_network( const char *filename );
+void unload_network(void);
+bool is_network_loaded(void);
+void refresh_network(void);
+void update_network( int i, int j, int old_color, int new_color );
+int  get_network_value(void);
+
+#endif
+
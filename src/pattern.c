@@ -0,0 +1,203 @@
+#include <stdbool.h>
+#include <pthread.h>
+#include "global_const.h"
+#include "pattern.h"
+
+
+/**
+ * @file    pattern.c
+ *
+ * @brief   3x3 shape patterns.
+ *
+ * The eight neighbours of a vertex are coded with two bits each
+ * (PATTERN_EMPTY, PATTERN_BLACK, PATTERN_WHITE or PATTERN_OFF), which gives
+ * a 16 bit pattern. The neighbour in direction k is stored in bits 2k and
+ * 2k+1. The directions are N, NE, E, SE, S, SW, W and NW, so the even
+ * directions are the direct neighbours.
+ *
+ * The boards keep the pattern of every vertex up to date: when the color of
+ * a vertex changes from code a to code b, the pattern of its neighbour in
+ * direction k is xor-ed with ( a ^ b ) << 2 * ( ( k + 4 ) % 8 ).
+ *
+ * The weight of a move for every pattern and color is computed once by
+ * init_patterns() from a few shape rules. Higher weights mean more urgent
+ * moves.
+ *
+ */
+
+//! Horizontal offset per direction.
+static const int direction_i[8] = {  0,  1, 1, 1, 0, -1, -1, -1 };
+//! Vertical offset per direction.
+static const int direction_j[8] = { -1, -1, 0, 1, 1,  1,  0, -1 };
+
+//! Weight of a move for WHITE (index 0) and BLACK (index 1) per pattern.
+static unsigned char pattern_weight[2][PATTERN_COUNT];
+//! Makes sure that pattern_weight[][] is filled exactly once.
+static pthread_once_t pattern_once = PTHREAD_ONCE_INIT;
+
+static void fill_pattern_weights(void);
+static int compute_weight( int color, unsigned int pattern );
+
+
+/**
+ * @brief       Fills the weight table of all patterns.
+ *
+ * Does nothing if the table has been filled before. The table is shared by
+ * all threads; concurrent first calls are safe, every caller returns after
+ * the table has been filled.
+ *
+ * @return      Nothing
+ */
+void init_patterns(void)
+{
+
+    pthread_once( &pattern_once, fill_pattern_weights );
+
+    return;
+}
+
+/**
+ * @brief       Computes the weight of every pattern for both colors.
+ *
+ * @return      Nothing
+ * @sa          init_patterns()
+ */
+void fill_pattern_weights(void)
+{
+    unsigned int pattern;
+
+    for ( pattern = 0; pattern < PATTERN_COUNT; pattern++ ) {
+        pattern_weight[0][pattern] = compute_weight( WHITE, pattern );
+        pattern_weight[1][pattern] = compute_weight( BLACK, pattern );
+    }
+
+    return;
+}
+
+/**
+ * @brief       Computes the weight of a move.
+ *
+ * - A move next to no stone gets weight 1.
+ * - A move in contact gets weight 10.
+ * - A hane, i.e. a move next to an opponent stone and diagonal to an own
+ *   stone next to the same opponent stone, adds 20.
+ * - A move between two opponent stones that are not connected diagonally
+ *   (a cut) adds 30.
+ * - A move between two own stones with an opponent stone on the diagonal
+ *   (defending a cut) adds 30.
+ * - A move on the first line loses 5.
+ * - A move whose direct neighbours are all own stones or off the board gets
+ *   weight 0.
+ *
+ * @param[in]   color       Color to move
+ * @param[in]   pattern     Pattern of the vertex
+ * @return      Weight of the move
+ */
+int compute_weight( int color, unsigned int pattern )
+{
+    int k;
+    int n[8];
+    int own = ( color == BLACK ) ? PATTERN_BLACK : PATTERN_WHITE;
+    int opp = ( color == BLACK ) ? PATTERN_WHITE : PATTERN_BLACK;
+    int stones = 0;
+    int own_or_off = 0;
+    bool is_edge = false;
+    int weight;
+
+    for ( k = 0; k < 8; k++ ) {
+        n[k] = ( pattern >> ( 2 * k ) ) & 3;
+        if ( n[k] == PATTERN_BLACK || n[k] == PATTERN_WHITE ) {
+            stones++;
+        }
+    }
+
+    for ( k = 0; k < 8; k += 2 ) {
+        if ( n[k] == own || n[k] == PATTERN_OFF ) {
+            own_or_off++;
+        }
+        if ( n[k] == PATTERN_OFF ) {
+            is_edge = true;
+        }
+    }
+    if ( own_or_off == 4 ) {
+        return 0;
+    }
+    if ( stones == 0 ) {
+        return 1;
+    }
+
+    weight = 10;
+
+    for ( k = 0; k < 8; k += 2 ) {
+        // Hane, an own stone diagonal next to the opponent stone:
+        if ( n[k] == opp && ( n[ ( k + 1 ) % 8 ] == own || n[ ( k + 7 ) % 8 ] == own ) ) {
+            weight += 20;
+        }
+        // Cut:
+        if ( n[k] == opp && n[ ( k + 2 ) % 8 ] == opp && n[ ( k + 1 ) % 8 ] != opp ) {
+            weight += 30;
+        }
+        // Defend cut:
+        if ( n[k] == own && n[ ( k + 2 ) % 8 ] == own && n[ ( k + 1 ) % 8 ] == opp ) {
+            weight += 30;
+        }
+    }
+
+    if ( is_edge ) {
+        weight -= 5;
+    }
+
+    return ( weight > 255 ) ? 255 : weight;
+}
+
+/**
+ * @brief       Returns the pattern code of a color.
+ *
+ * @param[in]   color   BLACK|WHITE|EMPTY or any other value for off board
+ * @return      PATTERN_EMPTY|PATTERN_BLACK|PATTERN_WHITE|PATTERN_OFF
+ */
+int get_pattern_code( int color )
+{
+
+    switch (color) {
+        case EMPTY:
+            return PATTERN_EMPTY;
+        case BLACK:
+            return PATTERN_BLACK;
+        case WHITE:
+            return PATTERN_WHITE;
+        default:
+            return PATTERN_OFF;
+    }
+}
+
+/**
+ * @brief       Returns the index offsets of the eight directions.
+ *
+ * @param[in]   width   Row length of the board array
+ * @param[out]  offsets Index offset per direction
+ * @return      Nothing
+ */
+void get_pattern_offsets( int width, int offsets[8] )
+{
+    int k;
+
+    for ( k = 0; k < 8; k++ ) {
+        offsets[k] = direction_j[k] * width + direction_i[k];
+    }
+
+    return;
+}
+
+/**
+ * @brief       Returns the weight of a move.
+ *
+ * @param[in]   color   Color to move
+ * @param[in]   pattern Pattern of the vertex
+ * @return      Weight, 0 to 255
+ */
+int get_pattern_weight( int color, unsigned short pattern )
+{
+
+    return pattern_weight[ color == BLACK ][pattern];
+}
@@ -0,0 +1,28 @@
+#ifndef PATTERN_H
+#define PATTERN_H
+
+/**
+ * @file    pattern.h
+ *
+ * @brief   Interface definition for pattern.c
+ *
+ */
+
+#include <stdbool.h>
+#include "global_const.h"
+
+#define PATTERN_EMPTY   0   //!< Pattern code of an empty vertex.
+#define PATTERN_BLACK   1   //!< Pattern code of a black stone.
+#define PATTERN_WHITE   2   //!< Pattern code of a white stone.
+#define PATTERN_OFF     3   //!< Pattern code of a vertex off the board.
+
+//! Number of different 3x3 neighbourhood codes.
+#define PATTERN_COUNT   65536
+
+void init_patterns(void);
+int  get_pattern_code( int color );
+void get_pattern_offsets( int width, int offsets[8] );
+int  get_pattern_weight( int color, unsigned short pattern );
+
+#endif
+
@@ -1,11 +1,16 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include "global_tools.h"
 #include "global_const.h"
 #include "board.h"
 #include "board_intern.h"
 #include "run_program.h"
+#include "playout.h"
+#include "mcts.h"
+#include "search.h"
+#include "move.h"
 
 
 /**
@@ -20,18 +25,35 @@
 
 void perf_scan_1(void);
 void perf_scan_1_upd(void);
+void perf_playouts( int board_size, int count );
+void perf_mcts( int board_size, int count, int max_threads );
 
 /**
  * @brief       Dummy main function.
  *
  * A placeholder for the main functio,
  *
+ * Called as "perf playouts [size] [count]" the playout benchmark is run,
+ * called as "perf mcts [size] [count] [threads]" the tree search benchmark.
+ *
+ * @param[in]   argc    Number of command line arguments
+ * @param[in]   argv    Array of command line arguments
  * @return      Return exit code
  * @note        May be used for simple testing.
  */
-int main(void)
+int main( int argc, char **argv )
 {
 
+    if ( argc > 1 && strcmp( argv[1], "playouts" ) == 0 ) {
+        perf_playouts( argc > 2 ? atoi( argv[2] ) : 9, argc > 3 ? atoi( argv[3] ) : 100000 );
+        return EXIT_SUCCESS;
+    }
+    if ( argc > 1 && strcmp( argv[1], "mcts" ) == 0 ) {
+        perf_mcts( argc > 2 ? atoi( argv[2] ) : 9, argc > 3 ? atoi( argv[3] ) : 100000
+            , argc > 4 ? atoi( argv[4] ) : 8 );
+        return EXIT_SUCCESS;
+    }
+
     //perf_scan_1();
     perf_scan_1_upd();
 
@@ -217,3 +239,108 @@ void perf_scan_1_upd(void)
     return;
 }
 
+/**
+ * @brief       Performance test for random playouts
+ *
+ * Plays the given number of random games from the empty board and prints
+ * the number of playouts per second.
+ *
+ * @param[in]   board_size  Size of the board
+ * @param[in]   count       Number of playouts
+ * @return      Nothing
+ */
+void perf_playouts( int board_size, int count )
+{
+    int k;
+    int black_wins = 0;
+    playout_board_t empty_board;
+    playout_board_t board;
+
+    // Variables for measuring time:
+    struct timespec start;
+    struct timespec stop;
+    long long int   diff_msec;
+
+    if ( board_size < BOARD_SIZE_MIN || board_size > BOARD_SIZE_MAX || count < 1 ) {
+        fprintf( stderr, "invalid board size or number of playouts\n" );
+        return;
+    }
+
+    init_board(board_size);
+    init_playout_board( &empty_board, INVALID, INVALID );
+
+    (void) clock_gettime( CLOCK_MONOTONIC, &start );
+    for ( k = 0; k < count; k++ ) {
+        board = empty_board;
+        play_random_playout( &board, BLACK, NULL );
+        if ( get_playout_score( &board, 0.5 ) > 0 ) {
+            black_wins++;
+        }
+    }
+    (void) clock_gettime( CLOCK_MONOTONIC, &stop );
+
+    diff_msec = (long long int)( stop.tv_sec - start.tv_sec ) * 1000
+              + ( stop.tv_nsec - start.tv_nsec ) / 1000000;
+    if ( diff_msec <= 0 ) {
+        diff_msec = 1;
+    }
+
+    printf( "Board size:  %d\n",   board_size );
+    printf( "Playouts:    %d\n",   count );
+    printf( "Black wins:  %d\n",   black_wins );
+    printf( "Time (ms):   %lld\n", diff_msec );
+    printf( "Playouts/s:  %lld\n", count * 1000LL / diff_msec );
+
+    free_board();
+
+    return;
+}
+
+/**
+ * @brief       Performance test for the Monte Carlo tree search
+ *
+ * Searches the empty board with 1, 2, 4, ... threads up to the given number
+ * and prints the number of playouts per second for every thread count.
+ *
+ * @param[in]   board_size  Size of the board
+ * @param[in]   count       Number of playouts per search
+ * @param[in]   max_threads Maximum number of threads
+ * @return      Nothing
+ */
+void perf_mcts( int board_size, int count, int max_threads )
+{
+    int i, j;
+    int threads;
+    unsigned long long int single = 1;
+    search_stats_t stats;
+
+    if ( board_size < BOARD_SIZE_MIN || board_size > BOARD_SIZE_MAX || count < 1
+            || max_threads < 1 || max_threads > MAX_THREADS ) {
+        fprintf( stderr, "invalid board size, number of playouts or threads\n" );
+        return;
+    }
+
+    init_board(board_size);
+    init_move_history();
+    set_playouts(count);
+
+    printf( "Board size: %d, playouts: %d\n", board_size, count );
+    printf( "Threads  Playouts/s  Speedup  Move\n" );
+    for ( threads = 1; threads <= max_threads; threads *= 2 ) {
+        set_thread_count(threads);
+        // Every search starts with an empty tree:
+        free_search_tree();
+        mcts_search( BLACK, 7.5, &i, &j );
+        stats = get_search_stats();
+        if ( threads == 1 ) {
+            single = ( stats.playouts_per_sec > 0 ) ? stats.playouts_per_sec : 1;
+        }
+        printf( "%7d  %10llu  %7.2f  %s\n", stats.threads, stats.playouts_per_sec
+            , (double)stats.playouts_per_sec / single, stats.move );
+    }
+
+    free_node_pool();
+    free_board();
+
+    return;
+}
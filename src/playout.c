@@ -0,0 +1,737 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "global_const.h"
+#include "board.h"
+#include "pattern.h"
+#include "playout.h"
+
+
+/**
+ * @file    playout.c
+ *
+ * @brief   Light board for fast random playouts.
+ *
+ * The board of board.c rebuilds all worm data after every move, which is
+ * far too slow for playing thousands of random games per move. The
+ * playout board only keeps what is needed for playing legal moves:
+ *
+ * - Strings as circular lists of stones, merged on the fly.
+ * - Pseudo-liberties per string. A string is captured when its count
+ *   drops to zero, and it is in atari on vertex v when all its
+ *   pseudo-liberties are adjacencies to v.
+ * - A list of empty vertices for picking random moves.
+ *
+ * Random moves never fill an own eye, so a playout ends when both colors
+ * have to pass. The final position is scored by area.
+ *
+ * Before a random move is chosen, the neighbours of the last move are
+ * checked for urgent moves: shape moves by the 3x3 pattern weight of the
+ * vertex, captures and atari escapes. If there are any, one of them is
+ * played, chosen at random by weight.
+ *
+ */
+
+//! Color value of the border vertices.
+#define PLAYOUT_OFF 2
+
+//! Weight added to a move that captures a string in atari.
+#define CAPTURE_WEIGHT  100
+//! Weight added to a move that extends an own string in atari.
+#define ESCAPE_WEIGHT   50
+//! Minimum weight of a move next to the last move to be played first.
+#define URGENT_WEIGHT   30
+
+static __thread unsigned long long int rand_state = 0x853C49E6748FEA9BULL;  //!< State of random number generator.
+
+static void add_stone( playout_board_t *pb, int color, int v );
+static void update_pattern( playout_board_t *pb, int v, int old_color, int new_color );
+static void remove_string( playout_board_t *pb, int head );
+static void merge_strings( playout_board_t *pb, int head_1, int head_2 );
+static bool is_legal( const playout_board_t *pb, int color, int v );
+static bool is_eye( const playout_board_t *pb, int color, int v );
+static bool play_vertex( playout_board_t *pb, int color, int v );
+static int  play_random_move( playout_board_t *pb, int color );
+static int  play_urgent_move( playout_board_t *pb, int color, int last );
+
+
+/**
+ * @brief       Initialises a playout board from the current position.
+ *
+ * Copies the position of board.c into the playout board and builds the
+ * string data.
+ *
+ * @param[out]  pb      Playout board
+ * @param[in]   ko_i    Horizontal coordinate of forbidden ko vertex or INVALID
+ * @param[in]   ko_j    Vertical coordinate of forbidden ko vertex or INVALID
+ * @return      Nothing
+ */
+void init_playout_board( playout_board_t *pb, int ko_i, int ko_j )
+{
+    int i, j;
+    int k;
+    int v;
+    int color;
+    int board_size = get_board_size();
+
+    pb->board_size  = board_size;
+    pb->width       = board_size + 2;
+    pb->empty_count = 0;
+    get_pattern_offsets( pb->width, pb->pattern_offset );
+
+    for ( v = 0; v < pb->width * pb->width; v++ ) {
+        pb->color[v]  = PLAYOUT_OFF;
+        pb->string[v] = 0;
+    }
+
+    // All vertices empty first:
+    for ( j = 0; j < board_size; j++ ) {
+        for ( i = 0; i < board_size; i++ ) {
+            v = get_playout_vertex( pb, i, j );
+            pb->color[v] = EMPTY;
+            pb->empty_index[v] = pb->empty_count;
+            pb->empty[pb->empty_count++] = v;
+        }
+    }
+
+    // Patterns of the empty board, stones are added incrementally:
+    init_patterns();
+    for ( j = 0; j < board_size; j++ ) {
+        for ( i = 0; i < board_size; i++ ) {
+            v = get_playout_vertex( pb, i, j );
+            pb->pattern[v] = 0;
+            for ( k = 0; k < 8; k++ ) {
+                if ( pb->color[ v + pb->pattern_offset[k] ] == PLAYOUT_OFF ) {
+                    pb->pattern[v] |= PATTERN_OFF << ( 2 * k );
+                }
+            }
+        }
+    }
+
+    // Stones of a legal position need no capture check:
+    for ( j = 0; j < board_size; j++ ) {
+        for ( i = 0; i < board_size; i++ ) {
+            color = get_vertex( i, j );
+            if ( color == BLACK || color == WHITE ) {
+                add_stone( pb, color, get_playout_vertex( pb, i, j ) );
+            }
+        }
+    }
+
+    pb->ko = ( ko_i == INVALID ) ? 0 : get_playout_vertex( pb, ko_i, ko_j );
+
+    return;
+}
+
+/**
+ * @brief       Returns the playout board index of a vertex.
+ *
+ * @param[in]   pb      Playout board
+ * @param[in]   i       Horizontal coordinate
+ * @param[in]   j       Vertical coordinate
+ * @return      Index of vertex
+ */
+int get_playout_vertex( const playout_board_t *pb, int i, int j )
+{
+
+    return ( j + 1 ) * pb->width + ( i + 1 );
+}
+
+/**
+ * @brief       Plays a move on the playout board.
+ *
+ * Sets the stone, removes captured strings and updates the ko vertex. A
+ * pass is given as INVALID coordinates.
+ *
+ * @param[in,out] pb    Playout board
+ * @param[in]   color   Color to move
+ * @param[in]   i       Horizontal coordinate or INVALID
+ * @param[in]   j       Vertical coordinate or INVALID
+ * @return      false if the move is not legal
+ */
+bool play_playout_move( playout_board_t *pb, int color, int i, int j )
+{
+
+    if ( i == INVALID ) {
+        pb->ko = 0;
+        return true;
+    }
+
+    return play_vertex( pb, color, get_playout_vertex( pb, i, j ) );
+}
+
+/**
+ * @brief       Plays a move given by its index on the playout board.
+ *
+ * @param[in,out] pb    Playout board
+ * @param[in]   color   Color to move
+ * @param[in]   v       Index of vertex
+ * @return      false if the move is not legal
+ */
+bool play_playout_vertex( playout_board_t *pb, int color, int v )
+{
+
+    return play_vertex( pb, color, v );
+}
+
+/**
+ * @brief       Returns all sensible moves of a color.
+ *
+ * Collects all legal moves that do not fill an own eye.
+ *
+ * @param[in]   pb      Playout board
+ * @param[in]   color   Color to move
+ * @param[out]  moves   List of moves (i, j)
+ * @return      Number of moves
+ */
+int get_playout_moves( const playout_board_t *pb, int color, int moves[][2] )
+{
+    int k;
+    int v;
+    int count = 0;
+
+    for ( k = 0; k < pb->empty_count; k++ ) {
+        v = pb->empty[k];
+        if ( is_legal( pb, color, v ) && ! is_eye( pb, color, v ) ) {
+            moves[count][0] = v % pb->width - 1;
+            moves[count][1] = v / pb->width - 1;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief       Plays random moves until the game ends.
+ *
+ * Both colors play random legal moves that do not fill own eyes, until both
+ * pass. Urgent moves next to the last move are preferred. The number of
+ * moves is limited to avoid endless ko fights.
+ *
+ * If a move list is given, the vertex of every turn is recorded, 0 for a
+ * pass. The colors alternate, starting with the given color.
+ *
+ * @param[in,out] pb    Playout board
+ * @param[in]   color   Color to move
+ * @param[out]  moves   List of played vertices or NULL
+ * @return      Number of turns
+ * @note        The move list must have room for 3 * board_size^2 entries.
+ */
+int play_random_playout( playout_board_t *pb, int color, short moves[] )
+{
+    int passes      = 0;
+    int nr_of_moves = 0;
+    int max_moves   = pb->board_size * pb->board_size * 3;
+    int v           = 0;
+
+    while ( passes < 2 && nr_of_moves < max_moves ) {
+        v = play_urgent_move( pb, color, v );
+        if ( v == 0 ) {
+            v = play_random_move( pb, color );
+        }
+        if ( v != 0 ) {
+            passes = 0;
+        }
+        else {
+            pb->ko = 0;
+            passes++;
+        }
+        if ( moves != NULL ) {
+            moves[nr_of_moves] = v;
+        }
+        color *= -1;
+        nr_of_moves++;
+    }
+
+    return nr_of_moves;
+}
+
+/**
+ * @brief       Scores the position by area.
+ *
+ * Counts stones and empty vertices whose neighbours all have the same color.
+ * This is exact for the end of a playout, where all empty vertices are
+ * eyes.
+ *
+ * @param[in]   pb      Playout board
+ * @param[in]   komi    Komi
+ * @return      Score from the view of black
+ */
+float get_playout_score( const playout_board_t *pb, float komi )
+{
+    int i, j;
+    int k;
+    int v;
+    int color;
+    int owner;
+    int score = 0;
+    int neighbour[4] = { 1, -1, pb->width, -pb->width };
+
+    for ( j = 0; j < pb->board_size; j++ ) {
+        for ( i = 0; i < pb->board_size; i++ ) {
+            v = get_playout_vertex( pb, i, j );
+            if ( pb->color[v] != EMPTY ) {
+                score += pb->color[v];
+                continue;
+            }
+
+            owner = EMPTY;
+            for ( k = 0; k < 4; k++ ) {
+                color = pb->color[ v + neighbour[k] ];
+                if ( color == PLAYOUT_OFF ) {
+                    continue;
+                }
+                if ( color == EMPTY || ( owner != EMPTY && color != owner ) ) {
+                    // Vertex belongs to nobody:
+                    owner = EMPTY;
+                    break;
+                }
+                owner = color;
+            }
+            score += owner;
+        }
+    }
+
+    return (float)score - komi;
+}
+
+/**
+ * @brief       Returns a random number.
+ *
+ * Fast xorshift random number generator with a state per thread.
+ *
+ * @return      Random number
+ */
+unsigned int get_playout_random(void)
+{
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 7;
+    rand_state ^= rand_state << 17;
+
+    return (unsigned int)( rand_state >> 32 );
+}
+
+/**
+ * @brief       Adds a stone without checking for captures.
+ *
+ * Removes the vertex from the empty list, updates the pseudo-liberties of
+ * the neighbour strings and merges the stone with its own strings.
+ *
+ * @param[in,out] pb    Playout board
+ * @param[in]   color   BLACK|WHITE
+ * @param[in]   v       Index of an empty vertex
+ * @return      Nothing
+ */
+void add_stone( playout_board_t *pb, int color, int v )
+{
+    int k;
+    int n;
+    int last;
+    int neighbour[4] = { v + 1, v - 1, v + pb->width, v - pb->width };
+
+    // Remove vertex from empty list:
+    last = pb->empty[--pb->empty_count];
+    pb->empty[ pb->empty_index[v] ] = last;
+    pb->empty_index[last] = pb->empty_index[v];
+
+    update_pattern( pb, v, EMPTY, color );
+    pb->color[v]     = color;
+    pb->string[v]    = v;
+    pb->next[v]      = v;
+    pb->stones[v]    = 1;
+    pb->liberties[v] = 0;
+
+    for ( k = 0; k < 4; k++ ) {
+        n = neighbour[k];
+        if ( pb->color[n] == EMPTY ) {
+            pb->liberties[v]++;
+        }
+        else if ( pb->color[n] != PLAYOUT_OFF ) {
+            pb->liberties[ pb->string[n] ]--;
+        }
+    }
+
+    for ( k = 0; k < 4; k++ ) {
+        n = neighbour[k];
+        if ( pb->color[n] == color && pb->string[n] != pb->string[v] ) {
+            merge_strings( pb, pb->string[v], pb->string[n] );
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief       Merges two strings.
+ *
+ * The smaller string is relabeled to the head stone of the larger one.
+ *
+ * @param[in,out] pb    Playout board
+ * @param[in]   head_1  Head stone of first string
+ * @param[in]   head_2  Head stone of second string
+ * @return      Nothing
+ */
+void merge_strings( playout_board_t *pb, int head_1, int head_2 )
+{
+    int v;
+    int temp;
+
+    if ( pb->stones[head_1] < pb->stones[head_2] ) {
+        temp   = head_1;
+        head_1 = head_2;
+        head_2 = temp;
+    }
+
+    v = head_2;
+    do {
+        pb->string[v] = head_1;
+        v = pb->next[v];
+    } while ( v != head_2 );
+
+    temp = pb->next[head_1];
+    pb->next[head_1] = pb->next[head_2];
+    pb->next[head_2] = temp;
+
+    pb->stones[head_1]    += pb->stones[head_2];
+    pb->liberties[head_1] += pb->liberties[head_2];
+
+    return;
+}
+
+/**
+ * @brief       Removes a captured string.
+ *
+ * All stones of the string become empty and give back a pseudo-liberty to
+ * every adjacent string.
+ *
+ * @param[in,out] pb    Playout board
+ * @param[in]   head    Head stone of string
+ * @return      Nothing
+ */
+void remove_string( playout_board_t *pb, int head )
+{
+    int k;
+    int n;
+    int v = head;
+    int next;
+    int color = pb->color[head];
+    int neighbour[4] = { 1, -1, pb->width, -pb->width };
+
+    do {
+        next = pb->next[v];
+
+        update_pattern( pb, v, color, EMPTY );
+        pb->color[v]  = EMPTY;
+        pb->string[v] = 0;
+        pb->empty_index[v] = pb->empty_count;
+        pb->empty[pb->empty_count++] = v;
+
+        for ( k = 0; k < 4; k++ ) {
+            n = v + neighbour[k];
+            if ( pb->color[n] == color * -1 ) {
+                pb->liberties[ pb->string[n] ]++;
+            }
+        }
+
+        v = next;
+    } while ( v != head );
+
+    return;
+}
+
+/**
+ * @brief       Checks if a move is legal.
+ *
+ * A move is legal on an empty vertex that is not the ko vertex, if it has an
+ * empty neighbour, connects to an own string with another liberty, or
+ * captures an opponent string.
+ *
+ * @param[in]   pb      Playout board
+ * @param[in]   color   Color to move
+ * @param[in]   v       Index of vertex
+ * @return      true|false
+ */
+bool is_legal( const playout_board_t *pb, int color, int v )
+{
+    int k, l;
+    int n;
+    int head;
+    int adjacent;
+    int neighbour[4] = { v + 1, v - 1, v + pb->width, v - pb->width };
+
+    if ( pb->color[v] != EMPTY || v == pb->ko ) {
+        return false;
+    }
+
+    for ( k = 0; k < 4; k++ ) {
+        if ( pb->color[ neighbour[k] ] == EMPTY ) {
+            return true;
+        }
+    }
+
+    for ( k = 0; k < 4; k++ ) {
+        n = neighbour[k];
+        if ( pb->color[n] == PLAYOUT_OFF ) {
+            continue;
+        }
+
+        // Pseudo-liberties of the string that come from this vertex:
+        head     = pb->string[n];
+        adjacent = 0;
+        for ( l = 0; l < 4; l++ ) {
+            if ( pb->color[ neighbour[l] ] != PLAYOUT_OFF && pb->string[ neighbour[l] ] == head ) {
+                adjacent++;
+            }
+        }
+
+        if ( pb->color[n] == color && pb->liberties[head] > adjacent ) {
+            return true;
+        }
+        if ( pb->color[n] == color * -1 && pb->liberties[head] == adjacent ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief       Checks if a vertex is an eye of the given color.
+ *
+ * A vertex is an eye if all its neighbours are stones of the given color and
+ * at most one diagonal vertex (none at the edge) belongs to the opponent.
+ *
+ * @param[in]   pb      Playout board
+ * @param[in]   color   BLACK|WHITE
+ * @param[in]   v       Index of vertex
+ * @return      true|false
+ */
+bool is_eye( const playout_board_t *pb, int color, int v )
+{
+    int k;
+    int count_off      = 0;
+    int count_opponent = 0;
+    int w = pb->width;
+    int neighbour[4] = { v + 1, v - 1, v + w, v - w };
+    int diagonal[4]  = { v + w + 1, v + w - 1, v - w + 1, v - w - 1 };
+
+    for ( k = 0; k < 4; k++ ) {
+        if ( pb->color[ neighbour[k] ] != color && pb->color[ neighbour[k] ] != PLAYOUT_OFF ) {
+            return false;
+        }
+    }
+
+    for ( k = 0; k < 4; k++ ) {
+        if ( pb->color[ diagonal[k] ] == PLAYOUT_OFF ) {
+            count_off++;
+        }
+        else if ( pb->color[ diagonal[k] ] == color * -1 ) {
+            count_opponent++;
+        }
+    }
+
+    return ( count_off > 0 ) ? count_opponent == 0 : count_opponent <= 1;
+}
+
+/**
+ * @brief       Plays a move on a vertex.
+ *
+ * @param[in,out] pb    Playout board
+ * @param[in]   color   Color to move
+ * @param[in]   v       Index of vertex
+ * @return      false if the move is not legal
+ */
+bool play_vertex( playout_board_t *pb, int color, int v )
+{
+    int k;
+    int n;
+    int head;
+    int nr_of_captured = 0;
+    int captured       = 0;
+    int neighbour[4]   = { v + 1, v - 1, v + pb->width, v - pb->width };
+
+    if ( ! is_legal( pb, color, v ) ) {
+        return false;
+    }
+
+    add_stone( pb, color, v );
+
+    for ( k = 0; k < 4; k++ ) {
+        n = neighbour[k];
+        if ( pb->color[n] == color * -1 && pb->liberties[ pb->string[n] ] == 0 ) {
+            head = pb->string[n];
+            nr_of_captured += pb->stones[head];
+            captured = n;
+            remove_string( pb, head );
+        }
+    }
+
+    // A single stone with one liberty that captured a single stone:
+    head   = pb->string[v];
+    pb->ko = 0;
+    if ( nr_of_captured == 1 && pb->stones[head] == 1 && pb->liberties[head] == 1 ) {
+        pb->ko = captured;
+    }
+
+    return true;
+}
+
+/**
+ * @brief       Plays a random move.
+ *
+ * Starts at a random position of the empty list and plays the first legal
+ * move that does not fill an own eye.
+ *
+ * @param[in,out] pb    Playout board
+ * @param[in]   color   Color to move
+ * @return      Index of played vertex or 0 if no move is possible
+ */
+int play_random_move( playout_board_t *pb, int color )
+{
+    int k;
+    int v;
+    int start;
+    int count = pb->empty_count;
+
+    if ( count == 0 ) {
+        return 0;
+    }
+
+    start = get_playout_random() % count;
+    for ( k = 0; k < count; k++ ) {
+        v = pb->empty[ ( start + k ) % count ];
+        if ( ! is_eye( pb, color, v ) && play_vertex( pb, color, v ) ) {
+            return v;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       Plays an urgent move next to the last move.
+ *
+ * Collects the legal moves on the eight neighbours of the last move whose
+ * weight is at least URGENT_WEIGHT and plays one of them, chosen at random
+ * by weight.
+ *
+ * @param[in,out] pb    Playout board
+ * @param[in]   color   Color to move
+ * @param[in]   last    Index of last move or 0
+ * @return      Index of played vertex or 0 if there is no urgent move
+ */
+int play_urgent_move( playout_board_t *pb, int color, int last )
+{
+    int k;
+    int v;
+    int count = 0;
+    int total = 0;
+    int pick;
+    int moves[8];
+    int weights[8];
+
+    if ( last == 0 ) {
+        return 0;
+    }
+
+    for ( k = 0; k < 8; k++ ) {
+        v = last + pb->pattern_offset[k];
+        if ( pb->color[v] != EMPTY ) {
+            continue;
+        }
+        weights[count] = get_playout_weight( pb, color, v );
+        if ( weights[count] >= URGENT_WEIGHT && is_legal( pb, color, v ) && ! is_eye( pb, color, v ) ) {
+            moves[count] = v;
+            total += weights[count];
+            count++;
+        }
+    }
+
+    if ( count == 0 ) {
+        return 0;
+    }
+
+    pick = get_playout_random() % total;
+    for ( k = 0; pick >= weights[k]; k++ ) {
+        pick -= weights[k];
+    }
+    play_vertex( pb, color, moves[k] );
+
+    return moves[k];
+}
+
+/**
+ * @brief       Returns the weight of a move.
+ *
+ * The weight of the 3x3 pattern of the vertex is increased for captures and
+ * for extensions of own strings in atari.
+ *
+ * @param[in]   pb      Playout board
+ * @param[in]   color   Color to move
+ * @param[in]   v       Index of an empty vertex
+ * @return      Weight of move
+ */
+int get_playout_weight( const playout_board_t *pb, int color, int v )
+{
+    int k;
+    int n;
+    int weight = get_pattern_weight( color, pb->pattern[v] );
+    int neighbour[4] = { v + 1, v - 1, v + pb->width, v - pb->width };
+
+    for ( k = 0; k < 4; k++ ) {
+        n = neighbour[k];
+        if ( ( pb->color[n] == BLACK || pb->color[n] == WHITE )
+                && pb->liberties[ pb->string[n] ] == 1 ) {
+            weight += ( pb->color[n] == color ) ? ESCAPE_WEIGHT : CAPTURE_WEIGHT;
+        }
+    }
+
+    return weight;
+}
+
+/**
+ * @brief       Updates the 3x3 patterns of the neighbours of a vertex.
+ *
+ * @param[in,out] pb        Playout board
+ * @param[in]   v           Vertex whose color changes
+ * @param[in]   old_color   Color before the change
+ * @param[in]   new_color   Color after the change
+ * @return      Nothing
+ */
+void update_pattern( playout_board_t *pb, int v, int old_color, int new_color )
+{
+    int k;
+    int n;
+    unsigned int change = get_pattern_code(old_color) ^ get_pattern_code(new_color);
+
+    for ( k = 0; k < 8; k++ ) {
+        n = v + pb->pattern_offset[k];
+        if ( pb->color[n] != PLAYOUT_OFF ) {
+            // The vertex is in the opposite direction seen from n:
+            pb->pattern[n] ^= change << ( 2 * ( ( k + 4 ) % 8 ) );
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief       Sets the seed of the random number generator.
+ *
+ * Every search thread should use a different seed, so the threads do not
+ * play the same random games.
+ *
+ * @param[in]   seed    Seed
+ * @return      Nothing
+ */
+void set_playout_seed( unsigned int seed )
+{
+
+    rand_state = 0x853C49E6748FEA9BULL ^ ( (unsigned long long int)seed * 0x9E3779B97F4A7C15ULL );
+    if ( rand_state == 0 ) {
+        rand_state = 0x853C49E6748FEA9BULL;
+    }
+
+    return;
+}
@@ -0,0 +1,55 @@
+#ifndef PLAYOUT_H
+#define PLAYOUT_H
+
+/**
+ * @file    playout.h
+ *
+ * @brief   Interface definition for playout.c
+ *
+ */
+
+#include <stdbool.h>
+#include "global_const.h"
+
+//! Number of vertices of a playout board including the border.
+#define PLAYOUT_BOARD_MAX   ( ( BOARD_SIZE_MAX + 2 ) * ( BOARD_SIZE_MAX + 2 ) )
+
+/**
+ * @brief   Structure that represents a light board for playouts.
+ *
+ * Vertices are stored in a one dimensional array with a border of one
+ * vertex. Strings are circular lists of stones with pseudo-liberties,
+ * i.e. every pair of a stone and an adjacent empty vertex is counted.
+ * Every vertex on the board has its 3x3 pattern (see pattern.c).
+ *
+ **/
+typedef struct {
+    int         board_size;                         //!< Size of the board.
+    int         width;                              //!< Row length including border.
+    int         ko;                                 //!< Forbidden ko vertex or 0.
+    int         empty_count;                        //!< Number of empty vertices.
+    signed char color[PLAYOUT_BOARD_MAX];           //!< BLACK|WHITE|EMPTY or border.
+    short       string[PLAYOUT_BOARD_MAX];          //!< Head stone of string of a stone.
+    short       next[PLAYOUT_BOARD_MAX];            //!< Next stone of same string.
+    short       stones[PLAYOUT_BOARD_MAX];          //!< Number of stones, valid for head stone.
+    short       liberties[PLAYOUT_BOARD_MAX];       //!< Pseudo-liberties, valid for head stone.
+    short       empty[PLAYOUT_BOARD_MAX];           //!< List of empty vertices.
+    short       empty_index[PLAYOUT_BOARD_MAX];     //!< Position of vertex in empty list.
+    unsigned short pattern[PLAYOUT_BOARD_MAX];      //!< 3x3 pattern of the neighbours.
+    int         pattern_offset[8];                  //!< Index offset per pattern direction.
+} playout_board_t;
+
+void  init_playout_board( playout_board_t *pb, int ko_i, int ko_j );
+bool  play_playout_move( playout_board_t *pb, int color, int i, int j );
+bool  play_playout_vertex( playout_board_t *pb, int color, int v );
+int   get_playout_moves( const playout_board_t *pb, int color, int moves[][2] );
+int   play_random_playout( playout_board_t *pb, int color, short moves[] );
+float get_playout_score( const playout_board_t *pb, float komi );
+int   get_playout_vertex( const playout_board_t *pb, int i, int j );
+int   get_playout_weight( const playout_board_t *pb, int color, int v );
+
+unsigned int get_playout_random(void);
+void         set_playout_seed( unsigned int seed );
+
+#endif
+
@@ -16,6 +16,10 @@
 #include "sgf.h"
 #include "search.h"
 #include "evaluate.h"
+#include "hash.h"
+#include "mcts.h"
+#include "influence.h"
+#include "network.h"
 
 /**
  * @file    run_program.c
@@ -49,6 +53,12 @@ static struct command_func known_commands[COUNT_KNOWN_COMMANDS];
 //! The current komi value
 static float komi = 0.0;
 
+//! The engine used by genmove (ENGINE_ALPHABETA|ENGINE_MCTS)
+static int engine = ENGINE_ALPHABETA;
+
+//! Search on the opponent's time while waiting for the next command
+static bool ponder = false;
+
 static void read_opts( int argc, char ** argv );
 static void print_help_message(void);
 static void print_version(void);
@@ -56,6 +66,7 @@ static void set_quit_program(void);
 static bool is_color_valid( char color_str[], int *color );
 static bool is_vertex_valid( char vertex_str[], int *i, int *j );
 static bool is_vertex_pass( char vertex_str[] );
+static bool is_engine_valid( char engine_str[], int *engine_nr );
 
 /* Administrative commands */
 static void gtp_protocol_version( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
@@ -79,12 +90,26 @@ static void gtp_undo( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
 
 /* Regression commands */
 static void gtp_loadsgf( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
+static void gtp_final_score( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
 
 /* Debug commands */
 static void gtp_showboard( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
 static void gtp_hg_log( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
 static void gtp_hg_stats( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
 static void gtp_hg_factors( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
+static void gtp_hg_threads( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
+static void gtp_hg_selective( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
+static void gtp_hg_multipv( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
+static void gtp_hg_analyze( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
+static void gtp_hg_engine( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
+static void gtp_hg_playouts( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
+static void gtp_hg_rave( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
+static void gtp_hg_ponder( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
+static void gtp_hg_memory( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
+static void gtp_hg_bouzy( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
+static void gtp_hg_network( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
+static void gtp_hg_estimate( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] );
+static void add_score_output(void);
 
 
 /* SGF parsing commands */
@@ -117,7 +142,6 @@ int run( int argc, char **argv )
 
     // Initialization
     init_board(BOARD_SIZE_DEFAULT);
-    //init_hash_table();
     init_known_commands();
     init_brains();
     init_move_history();
@@ -128,6 +152,9 @@ int run( int argc, char **argv )
     // Read command line arguments:
     read_opts( argc, argv );
 
+    // The size of the hash table may be set by the command line:
+    init_hash_table();
+
     // Working loop:
     while ( quit_program == 0 ) {
         read_gtp_input(&command_data);
@@ -137,14 +164,26 @@ int run( int argc, char **argv )
             continue;
         }
 
+        // The command may change the position:
+        stop_pondering();
+
         if ( get_output_error() == false ) {
             select_command(&command_data);
         }
 
         print_output(command_data.id);
+
+        // Search for the side to move while waiting for the next command:
+        if ( ponder && engine == ENGINE_MCTS && quit_program == 0
+                && ( get_move_last_color() == BLACK || get_move_last_color() == WHITE ) ) {
+            start_pondering( get_move_last_color() * -1, komi );
+        }
     }
 
+    free_move_stack();
+    free_node_pool();
     free_board();
+    free_hash_table();
 
     return EXIT_SUCCESS;
 }
@@ -184,9 +223,43 @@ void set_quit_program(void)
 void read_opts( int argc, char **argv )
 {
     int opt;
+    int threads;
+    int count;
 
     while ( ( opt = getopt( argc, argv, VALID_OPTIONS ) ) != INVALID ) {
         switch (opt) {
+            case 't':
+                threads = atoi(optarg);
+                if ( threads < 1 || threads > MAX_THREADS ) {
+                    fprintf( stderr, "invalid number of threads: %s\n", optarg );
+                    free_board();
+                    exit(EXIT_FAILURE);
+                }
+                set_thread_count(threads);
+                break;
+            case 'e':
+                if ( ! is_engine_valid( optarg, &engine ) ) {
+                    fprintf( stderr, "invalid engine: %s\n", optarg );
+                    free_board();
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'p':
+                count = atoi(optarg);
+                if ( count < 1 || count > MAX_PLAYOUTS ) {
+                    fprintf( stderr, "invalid number of playouts: %s\n", optarg );
+                    free_board();
+                    exit(EXIT_FAILURE);
+                }
+                set_playouts(count);
+                break;
+            case 's':
+                if ( ! set_hash_table_size( atoi(optarg) ) ) {
+                    fprintf( stderr, "invalid hash table size: %s\n", optarg );
+                    free_board();
+                    exit(EXIT_FAILURE);
+                }
+                break;
             case 'h':
                 print_help_message();
                 set_quit_program();
@@ -284,12 +357,38 @@ void init_known_commands(void)
     known_commands[i++].function = (*gtp_undo);
     my_strcpy( known_commands[i].command, "loadsgf",          MAX_TOKEN_LENGTH );
     known_commands[i++].function = (*gtp_loadsgf);
+    my_strcpy( known_commands[i].command, "final_score",      MAX_TOKEN_LENGTH );
+    known_commands[i++].function = (*gtp_final_score);
     my_strcpy( known_commands[i].command, "hg-log",           MAX_TOKEN_LENGTH );
     known_commands[i++].function = (*gtp_hg_log);
     my_strcpy( known_commands[i].command, "hg-stats",         MAX_TOKEN_LENGTH );
     known_commands[i++].function = (*gtp_hg_stats);
     my_strcpy( known_commands[i].command, "hg-factors",       MAX_TOKEN_LENGTH );
     known_commands[i++].function = (*gtp_hg_factors);
+    my_strcpy( known_commands[i].command, "hg-threads",       MAX_TOKEN_LENGTH );
+    known_commands[i++].function = (*gtp_hg_threads);
+    my_strcpy( known_commands[i].command, "hg-selective",     MAX_TOKEN_LENGTH );
+    known_commands[i++].function = (*gtp_hg_selective);
+    my_strcpy( known_commands[i].command, "hg-multipv",       MAX_TOKEN_LENGTH );
+    known_commands[i++].function = (*gtp_hg_multipv);
+    my_strcpy( known_commands[i].command, "hg-analyze",       MAX_TOKEN_LENGTH );
+    known_commands[i++].function = (*gtp_hg_analyze);
+    my_strcpy( known_commands[i].command, "hg-engine",        MAX_TOKEN_LENGTH );
+    known_commands[i++].function = (*gtp_hg_engine);
+    my_strcpy( known_commands[i].command, "hg-playouts",      MAX_TOKEN_LENGTH );
+    known_commands[i++].function = (*gtp_hg_playouts);
+    my_strcpy( known_commands[i].command, "hg-rave",          MAX_TOKEN_LENGTH );
+    known_commands[i++].function = (*gtp_hg_rave);
+    my_strcpy( known_commands[i].command, "hg-ponder",        MAX_TOKEN_LENGTH );
+    known_commands[i++].function = (*gtp_hg_ponder);
+    my_strcpy( known_commands[i].command, "hg-memory",        MAX_TOKEN_LENGTH );
+    known_commands[i++].function = (*gtp_hg_memory);
+    my_strcpy( known_commands[i].command, "hg-bouzy",         MAX_TOKEN_LENGTH );
+    known_commands[i++].function = (*gtp_hg_bouzy);
+    my_strcpy( known_commands[i].command, "hg-network",       MAX_TOKEN_LENGTH );
+    known_commands[i++].function = (*gtp_hg_network);
+    my_strcpy( known_commands[i].command, "hg-estimate",      MAX_TOKEN_LENGTH );
+    known_commands[i++].function = (*gtp_hg_estimate);
 
     //DEBUG:
     my_strcpy( known_commands[i].command, "showgroups", MAX_TOKEN_LENGTH );
@@ -526,6 +625,7 @@ void gtp_boardsize( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
     free_board();
     init_board(board_size);
     init_move_history();
+    clear_hash_table();
 
     return;
 }
@@ -551,6 +651,7 @@ void gtp_clear_board( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
     free_board();
     init_board(board_size);
     init_move_history();
+    clear_hash_table();
 
     return;
 }
@@ -814,6 +915,7 @@ void gtp_play( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
         create_next_move();
         set_move_pass(color);
         push_move();
+        mcts_play_move( color, INVALID, INVALID );
 
         return;
     }
@@ -882,6 +984,9 @@ void gtp_play( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
     // Add move to move history:
     push_move();
 
+    // Keep the part of the search tree that belongs to the new position:
+    mcts_play_move( color, i, j );
+
     return;
 }
 
@@ -982,6 +1087,33 @@ bool is_vertex_pass( char vertex_str[] )
     return is_pass;
 }
 
+/**
+ * @brief       Checks if a given engine name is valid.
+ *
+ * Checks if the given string names a search engine (alphabeta or mcts) and
+ * returns its number.
+ *
+ * @param[in]   engine_str  The given engine string.
+ * @param[out]  engine_nr   ENGINE_ALPHABETA|ENGINE_MCTS
+ * @return      true|false
+ */
+bool is_engine_valid( char engine_str[], int *engine_nr )
+{
+    bool is_valid = true;
+
+    if ( strcmp( engine_str, "alphabeta" ) == 0 ) {
+        *engine_nr = ENGINE_ALPHABETA;
+    }
+    else if ( strcmp( engine_str, "mcts" ) == 0 ) {
+        *engine_nr = ENGINE_MCTS;
+    }
+    else {
+        is_valid = false;
+    }
+
+    return is_valid;
+}
+
 
 /// @defgroup GTP_Debug_Commands Go Text Protocol Debug Commands
 /// @ingroup GTP_Commands
@@ -1057,12 +1189,18 @@ void gtp_genmove( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
     // TEST:
     i = INVALID;
     j = INVALID;
-    search_tree( color, &i, &j );
+    if ( engine == ENGINE_MCTS ) {
+        mcts_search( color, komi, &i, &j );
+    }
+    else {
+        search_tree( color, &i, &j );
+    }
 
     if ( i == INVALID && j == INVALID ) {
         create_next_move();
         set_move_pass(color);
         push_move();
+        mcts_play_move( color, INVALID, INVALID );
 
         add_output("pass");
 
@@ -1094,6 +1232,7 @@ void gtp_genmove( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
         set_move_ko( captured_now[0][0], captured_now[0][1] );
     }
     push_move();
+    mcts_play_move( color, i, j );
 
     // Create vertex for output:
     i_to_x( i, x );
@@ -1105,6 +1244,75 @@ void gtp_genmove( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
     return;
 }
 
+/**
+ * @brief       Returns the final score.
+ *
+ * The score is the area of both colors (see get_area_estimate()) with the
+ * komi added for white. The result is printed as "B+x", "W+x" or "0".
+ *
+ * @param[in]   gtp_argc    Number of arguments of GTP command
+ * @param[in]   gtp_argv    Array of all arguments for GTP command
+ * @return      Nothing
+ * @sa          Go Text Protokol version 2, 6.3.4 Tournament Commands
+ * @note        Dead stones are not removed, so this is only exact for
+ *              games that have been played out. Use hg-estimate for
+ *              positions in the middle of the game.
+ */
+void gtp_final_score( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
+{
+
+    add_score_output();
+
+    return;
+}
+
+/**
+ * @brief       Returns the estimated score of the current position.
+ *
+ * Prints the same score as final_score. On an unfinished game the empty
+ * vertices between the colors are given to the nearer color (see
+ * get_area_estimate()), so this is an estimate.
+ *
+ * @param[in]   gtp_argc    Number of arguments of GTP command
+ * @param[in]   gtp_argv    Array of all arguments for GTP command
+ * @return      Nothing
+ * @sa          gtp_final_score()
+ */
+void gtp_hg_estimate( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
+{
+
+    add_score_output();
+
+    return;
+}
+
+/**
+ * @brief       Adds the area score of the board to the output.
+ *
+ * @return      Nothing
+ */
+void add_score_output(void)
+{
+    float score;
+    char  output[20];
+
+    scan_board_1();
+    score = get_area_estimate() - komi;
+
+    if ( score > 0 ) {
+        snprintf( output, 20, "B+%g", score );
+    }
+    else if ( score < 0 ) {
+        snprintf( output, 20, "W+%g", -score );
+    }
+    else {
+        my_strcpy( output, "0", 20 );
+    }
+    add_output(output);
+
+    return;
+}
+
 /**
  * @brief       Loads an SGF file
  *
@@ -1538,6 +1746,7 @@ void gtp_hg_log( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
  */
 void gtp_hg_stats( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
 {
+    int k;
     char temp_str[100];
     search_stats_t stats = get_search_stats();
 
@@ -1554,6 +1763,8 @@ void gtp_hg_stats( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
     add_output(temp_str);
     snprintf( temp_str, 100, "# Nodes/sec: %llu", stats.nodes_per_sec );
     add_output(temp_str);
+    snprintf( temp_str, 100, "# Threads:   %d",   stats.threads       );
+    add_output(temp_str);
     snprintf( temp_str, 100, "# Q-Search:  %d",   stats.qsearch_count );
     add_output(temp_str);
     snprintf( temp_str, 100, "# Hash-Hit:  %d",   stats.hash_hit      );
@@ -1562,6 +1773,29 @@ void gtp_hg_stats( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
     add_output(temp_str);
     snprintf( temp_str, 100, "# Beta-Cut:  %d",   stats.beta_cut      );
     add_output(temp_str);
+    snprintf( temp_str, 100, "# Null-Cut:  %d",   stats.null_cut      );
+    add_output(temp_str);
+    snprintf( temp_str, 100, "# LMR:       %d",   stats.lmr_count     );
+    add_output(temp_str);
+    snprintf( temp_str, 100, "# LMR-Re:    %d",   stats.lmr_research  );
+    add_output(temp_str);
+    snprintf( temp_str, 100, "# Futility:  %d",   stats.futility_cut  );
+    add_output(temp_str);
+    snprintf( temp_str, 100, "# Eval-Hit:  %llu/%llu (%llu%%)", stats.eval_hits, stats.eval_probes
+        , stats.eval_probes > 0 ? stats.eval_hits * 100 / stats.eval_probes : 0 );
+    add_output(temp_str);
+    for ( k = 1; k < EVAL_TIERS; k++ ) {
+        snprintf( temp_str, 100, "# Eval-Skip: tier %d %llu/%llu", k, stats.eval_tier_skips[k], stats.eval_lazy );
+        add_output(temp_str);
+    }
+    snprintf( temp_str, 100, "# Playouts:  %d",   stats.playouts      );
+    add_output(temp_str);
+    snprintf( temp_str, 100, "# Playout/s: %llu", stats.playouts_per_sec );
+    add_output(temp_str);
+    snprintf( temp_str, 100, "# Reused:    %d",   stats.reused_visits );
+    add_output(temp_str);
+    snprintf( temp_str, 100, "# Tree:      %u",   stats.tree_nodes    );
+    add_output(temp_str);
     snprintf( temp_str, 100, "# Value:     %d",   stats.value         );
     add_output(temp_str);
 
@@ -1577,17 +1811,48 @@ void gtp_hg_stats( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
  * @param[in]   gtp_argv    Array of all arguments for GTP command
  * @return      Nothing
  */
-/*
 void gtp_hg_bouzy( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
 {
-    char board_output[MAX_OUTPUT_LENGTH * 10];
+    char board_output[MAX_OUTPUT_LENGTH];
 
     get_bouzy_as_string(board_output);
     add_output(board_output);
 
     return;
 }
-*/
+
+/**
+ * @brief       Loads a network for the network brain.
+ *
+ * The network is used as soon as its factor is set (see hg-factors).
+ *
+ * @param[in]   gtp_argc    Number of arguments of GTP command
+ * @param[in]   gtp_argv    Array of all arguments for GTP command
+ * @return      Nothing
+ * @sa          network.c
+ */
+void gtp_hg_network( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
+{
+
+    if ( gtp_argc < 1 ) {
+        set_output_error();
+        add_output("missing argument: filename");
+
+        return;
+    }
+
+    // Values of the old network must not be taken from the cache:
+    clear_eval_cache();
+
+    if ( ! load_network( gtp_argv[0] ) ) {
+        set_output_error();
+        add_output("cannot load network");
+
+        return;
+    }
+
+    return;
+}
 
 /**
  * @brief       Sets or prints evaluation factors.
@@ -1624,6 +1889,374 @@ void gtp_hg_factors( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
         set_factor( k, factor );
     }
 
+    // Stored values are no longer valid:
+    clear_hash_table();
+
     return;
 }
 
+/**
+ * @brief       Sets or prints number of search threads.
+ *
+ * Sets the number of threads that search a position at the same time. When
+ * called without arguments, the current value is shown.
+ *
+ * @param[in]   gtp_argc    Number of arguments of GTP command
+ * @param[in]   gtp_argv    Array of all arguments for GTP command
+ * @return      Nothing
+ */
+void gtp_hg_threads( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
+{
+    int  threads;
+    char output[4];
+
+    if ( gtp_argc == 0 ) {
+        snprintf( output, 4, "%d", get_thread_count() );
+        add_output(output);
+
+        return;
+    }
+
+    threads = atoi( gtp_argv[0] );
+
+    if ( threads < 1 || threads > MAX_THREADS ) {
+        set_output_error();
+        add_output("invalid number of threads");
+
+        return;
+    }
+
+    set_thread_count(threads);
+
+    return;
+}
+
+/**
+ * @brief       Switches selective search techniques on or off.
+ *
+ * Switches the given technique (null-move, lmr or futility) on or off. When
+ * called without arguments, the state of all techniques is shown.
+ *
+ * @param[in]   gtp_argc    Number of arguments of GTP command
+ * @param[in]   gtp_argv    Array of all arguments for GTP command
+ * @return      Nothing
+ */
+void gtp_hg_selective( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
+{
+    int  technique;
+    char output[50];
+
+    if ( gtp_argc == 0 ) {
+        snprintf( output, 50, "null-move %s lmr %s futility %s"
+            , get_selective(SELECT_NULL_MOVE) ? "on" : "off"
+            , get_selective(SELECT_LMR)       ? "on" : "off"
+            , get_selective(SELECT_FUTILITY)  ? "on" : "off" );
+        add_output(output);
+
+        return;
+    }
+
+    if ( gtp_argc != 2 ) {
+        set_output_error();
+        add_output("two arguments required: technique on|off");
+
+        return;
+    }
+
+    if ( strcmp( gtp_argv[0], "null-move" ) == 0 ) {
+        technique = SELECT_NULL_MOVE;
+    }
+    else if ( strcmp( gtp_argv[0], "lmr" ) == 0 ) {
+        technique = SELECT_LMR;
+    }
+    else if ( strcmp( gtp_argv[0], "futility" ) == 0 ) {
+        technique = SELECT_FUTILITY;
+    }
+    else {
+        set_output_error();
+        add_output("unknown technique");
+
+        return;
+    }
+
+    if ( strcmp( gtp_argv[1], "on" ) == 0 ) {
+        set_selective( technique, true );
+    }
+    else if ( strcmp( gtp_argv[1], "off" ) == 0 ) {
+        set_selective( technique, false );
+    }
+    else {
+        set_output_error();
+        add_output("invalid argument: on|off");
+
+        return;
+    }
+
+    // Stored values depend on the search:
+    clear_hash_table();
+
+    return;
+}
+
+/**
+ * @brief       Sets or prints number of analysed root moves.
+ *
+ * Sets the number of root moves whose exact values and principal variations
+ * are determined by the search (multi-PV). When called without arguments,
+ * the current value is shown.
+ *
+ * @param[in]   gtp_argc    Number of arguments of GTP command
+ * @param[in]   gtp_argv    Array of all arguments for GTP command
+ * @return      Nothing
+ */
+void gtp_hg_multipv( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
+{
+    int  count;
+    char output[4];
+
+    if ( gtp_argc == 0 ) {
+        snprintf( output, 4, "%d", get_multi_pv() );
+        add_output(output);
+
+        return;
+    }
+
+    count = atoi( gtp_argv[0] );
+
+    if ( count < 1 || count > MAX_MULTI_PV ) {
+        set_output_error();
+        add_output("invalid number of moves");
+
+        return;
+    }
+
+    set_multi_pv(count);
+
+    return;
+}
+
+/**
+ * @brief       Analyses the position for the given color.
+ *
+ * Searches the current position without playing a move. For every analysed
+ * root move (see hg-multipv) one line is printed with the move, its value,
+ * the search depth and the principal variation, best move first:
+ *
+ *     E5 value 3 depth 2 pv E5 D4 C3
+ *
+ * @param[in]   gtp_argc    Number of arguments of GTP command
+ * @param[in]   gtp_argv    Array of all arguments for GTP command
+ * @return      Nothing
+ */
+void gtp_hg_analyze( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
+{
+    int  k, l;
+    int  color;
+    int  i, j;
+    int  nr_of_lines;
+    pv_line_t lines[MAX_MULTI_PV];
+    char x[2];
+    char y[3];
+    char temp_str[20];
+    char line[ 40 + MAX_PV_LENGTH * 4 ];
+
+    if ( gtp_argc < 1 || ! is_color_valid( gtp_argv[0], &color ) ) {
+        set_output_error();
+        add_output("invalid color");
+
+        return;
+    }
+
+    search_tree( color, &i, &j );
+    nr_of_lines = get_pv_lines(lines);
+
+    add_output("");
+    for ( k = 0; k < nr_of_lines; k++ ) {
+        i_to_x( lines[k].i, x );
+        j_to_y( lines[k].j, y );
+        snprintf( line, sizeof(line), "%s%s value %d depth %d pv"
+            , x, y, lines[k].value, lines[k].depth );
+
+        for ( l = 0; l < lines[k].pv_length; l++ ) {
+            i_to_x( lines[k].pv[l][0], x );
+            j_to_y( lines[k].pv[l][1], y );
+            snprintf( temp_str, sizeof(temp_str), " %s%s", x, y );
+            strcat( line, temp_str );
+        }
+        add_output(line);
+    }
+
+    return;
+}
+
+/**
+ * @brief       Selects or prints the search engine.
+ *
+ * Selects the engine used by genmove: alphabeta (the default) or mcts. When
+ * called without arguments, the current engine is shown.
+ *
+ * @param[in]   gtp_argc    Number of arguments of GTP command
+ * @param[in]   gtp_argv    Array of all arguments for GTP command
+ * @return      Nothing
+ */
+void gtp_hg_engine( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
+{
+
+    if ( gtp_argc == 0 ) {
+        add_output( ( engine == ENGINE_MCTS ) ? "mcts" : "alphabeta" );
+
+        return;
+    }
+
+    if ( ! is_engine_valid( gtp_argv[0], &engine ) ) {
+        set_output_error();
+        add_output("invalid engine");
+
+        return;
+    }
+
+    return;
+}
+
+/**
+ * @brief       Sets or prints number of playouts.
+ *
+ * Sets the number of playouts of the Monte Carlo tree search. When called
+ * without arguments, the current value is shown.
+ *
+ * @param[in]   gtp_argc    Number of arguments of GTP command
+ * @param[in]   gtp_argv    Array of all arguments for GTP command
+ * @return      Nothing
+ */
+void gtp_hg_playouts( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
+{
+    int  count;
+    char output[12];
+
+    if ( gtp_argc == 0 ) {
+        snprintf( output, 12, "%d", get_playouts() );
+        add_output(output);
+
+        return;
+    }
+
+    count = atoi( gtp_argv[0] );
+
+    if ( count < 1 || count > MAX_PLAYOUTS ) {
+        set_output_error();
+        add_output("invalid number of playouts");
+
+        return;
+    }
+
+    set_playouts(count);
+
+    return;
+}
+
+/**
+ * @brief       Switches RAVE of the Monte Carlo tree search on or off.
+ *
+ * Switches the use of AMAF values for node selection on or off. When called
+ * without arguments, the current state is shown.
+ *
+ * @param[in]   gtp_argc    Number of arguments of GTP command
+ * @param[in]   gtp_argv    Array of all arguments for GTP command
+ * @return      Nothing
+ */
+void gtp_hg_rave( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
+{
+
+    if ( gtp_argc == 0 ) {
+        add_output( get_rave() ? "on" : "off" );
+
+        return;
+    }
+
+    if ( strcmp( gtp_argv[0], "on" ) == 0 ) {
+        set_rave(true);
+    }
+    else if ( strcmp( gtp_argv[0], "off" ) == 0 ) {
+        set_rave(false);
+    }
+    else {
+        set_output_error();
+        add_output("invalid argument: on|off");
+
+        return;
+    }
+
+    return;
+}
+
+/**
+ * @brief       Switches pondering on or off.
+ *
+ * With pondering on, the Monte Carlo tree search goes on in the background
+ * while the program waits for the next GTP command. When called without
+ * arguments, the current state is shown.
+ *
+ * @param[in]   gtp_argc    Number of arguments of GTP command
+ * @param[in]   gtp_argv    Array of all arguments for GTP command
+ * @return      Nothing
+ */
+void gtp_hg_ponder( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
+{
+
+    if ( gtp_argc == 0 ) {
+        add_output( ponder ? "on" : "off" );
+
+        return;
+    }
+
+    if ( strcmp( gtp_argv[0], "on" ) == 0 ) {
+        ponder = true;
+    }
+    else if ( strcmp( gtp_argv[0], "off" ) == 0 ) {
+        ponder = false;
+    }
+    else {
+        set_output_error();
+        add_output("invalid argument: on|off");
+
+        return;
+    }
+
+    return;
+}
+
+/**
+ * @brief       Sets the memory limit of the Monte Carlo search tree.
+ *
+ * Sets the memory limit of the search tree in MB. When called without
+ * arguments, the current limit is shown.
+ *
+ * @param[in]   gtp_argc    Number of arguments of GTP command
+ * @param[in]   gtp_argv    Array of all arguments for GTP command
+ * @return      Nothing
+ */
+void gtp_hg_memory( int gtp_argc, char gtp_argv[][MAX_TOKEN_LENGTH] )
+{
+    int  megabytes;
+    char output[12];
+
+    if ( gtp_argc == 0 ) {
+        snprintf( output, 12, "%d", get_tree_memory() );
+        add_output(output);
+
+        return;
+    }
+
+    megabytes = atoi( gtp_argv[0] );
+
+    if ( megabytes < 1 || megabytes > MAX_TREE_MEMORY ) {
+        set_output_error();
+        add_output("invalid memory size");
+
+        return;
+    }
+
+    set_tree_memory(megabytes);
+
+    return;
+}
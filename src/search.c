@@ -3,11 +3,14 @@
 #include <time.h>
 #include <string.h>
 #include <limits.h>
+#include <pthread.h>
 #include "global_const.h"
 #include "board.h"
 #include "move.h"
 #include "evaluate.h"
 #include "global_tools.h"
+#include "hash.h"
+#include "pattern.h"
 #include "search.h"
 
 
@@ -21,25 +24,78 @@
  * the move with the best value is returned. For black the best move has the
  * highest number for white the lowest number.
  *
+ * If more than one thread is set, helper threads search the same position on
+ * their own copy of the board at the same time (Lazy SMP). The threads only
+ * share the transposition hash table, so the helpers fill the table with
+ * results the main thread can use.
  *
  */
 
-static unsigned hash_hit;   //!< Counts the hits in the hash table.
-static int alpha_break;     //!< Count alpha breaks.
-static int beta_break;      //!< Count beta breaks.
+static __thread unsigned hash_hit;  //!< Counts the hits in the hash table.
+static __thread int alpha_break;    //!< Count alpha breaks.
+static __thread int beta_break;     //!< Count beta breaks.
 
-static int count_quiet_search;  //!< Counts the nodes in quiescence search.
+static __thread int count_quiet_search; //!< Counts the nodes in quiescence search.
+
+static __thread int null_cut;       //!< Counts verified null move cut-offs.
+static __thread int lmr_count;      //!< Counts reduced late moves.
+static __thread int lmr_research;   //!< Counts reduced moves searched again.
+static __thread int futility_cut;   //!< Counts moves pruned by futility.
 
 static int search_depth = DEFAULT_SEARCH_DEPTH; //!< Sets depth of search tree.
+static int thread_count = DEFAULT_THREADS;      //!< Sets number of search threads.
+static int selective    = 0;                    //!< Set of SELECT_* techniques in use.
+static int multi_pv     = 1;                    //!< Number of root moves with exact value.
+
+static __thread int  max_depth;                 //!< Depth of the current iteration.
+static __thread bool is_helper = false;         //!< Indicates a helper search thread.
+static __thread bool in_null_verify = false;    //!< Indicates a null move verification search.
+static int stop_search = 0;                     //!< If set to 1 the helper threads stop.
 
-static unsigned long long int node_count;       //!< Counts the number of nodes in move tree.
+static __thread unsigned long long int node_count;  //!< Counts the number of nodes in move tree.
 
 static bool do_log    = false;                  //!< Defines if logging is turned on or off.
 static FILE *log_file = NULL;                   //!< Log file handler
 
 static search_stats_t search_stats;             //!< Information about last generated move.
 
+static pv_line_t pv_lines[MAX_MULTI_PV];        //!< Best root moves of last search.
+static int       pv_line_count = 0;             //!< Number of entries in pv_lines.
+
+/**
+ * @brief   Structure that describes a helper search thread.
+ *
+ **/
+typedef struct {
+    pthread_t thread;                       //!< Thread handle.
+    int       thread_nr;                    //!< Number of thread, starting with 1.
+    int       color;                        //!< Color to move.
+    const board_snapshot_t *snapshot;       //!< Position to search.
+    const move_t           *last_move;      //!< Last move of position (for ko).
+    unsigned long long int node_count;      //!< Number of nodes searched by thread.
+    int       qsearch_count;                //!< Number of quiet search nodes of thread.
+    unsigned  hash_hit;                     //!< Number of hash hits of thread.
+    int       alpha_cut;                    //!< Number of alpha cut-offs of thread.
+    int       beta_cut;                     //!< Number of beta cut-offs of thread.
+    int       null_cut;                     //!< Number of null move cut-offs of thread.
+    int       lmr_count;                    //!< Number of reduced moves of thread.
+    int       lmr_research;                 //!< Number of reduced moves searched again by thread.
+    int       futility_cut;                 //!< Number of futility pruned moves of thread.
+    unsigned long long int eval_probes;     //!< Number of evaluation cache lookups of thread.
+    unsigned long long int eval_hits;       //!< Number of evaluation cache hits of thread.
+    unsigned long long int eval_lazy;       //!< Number of evaluations with window of thread.
+    unsigned long long int eval_tier_skips[EVAL_TIERS]; //!< Number of skipped tiers of thread.
+} helper_t;
+
+static void search_root( int color, int valid_moves[][4], int nr_of_valid_moves, int depth_max, int thread_nr );
+static void *run_helper( void *arg );
+static bool is_search_stopped(void);
+static int  get_nth_value( int color, int valid_moves[][4], int count, int n );
+static int  get_pv_from_hash( int color, int i, int j, int pv[][2] );
+static void move_to_front( int valid_moves[][4], int nr_of_valid_moves, int i, int j );
 static int  add_node( int color, int depth, int alpha, int beta );
+static int  qsearch( int color, int qdepth, int alpha, int beta );
+static int  compare_pattern( int color, const void *move1, const void *move2 );
 static void make_move( int color, int i, int j );
 static void undo_move(void);
 
@@ -53,6 +109,8 @@ static void undo_move(void);
  */
 void init_search_stats(void)
 {
+    int tier;
+
     search_stats.color[0]      = '\0';
     search_stats.move[0]       = '\0';
     search_stats.level         = 0;
@@ -63,6 +121,21 @@ void init_search_stats(void)
     search_stats.alpha_cut     = 0;
     search_stats.beta_cut      = 0;
     search_stats.value         = 0;
+    search_stats.threads       = 0;
+    search_stats.null_cut      = 0;
+    search_stats.lmr_count     = 0;
+    search_stats.lmr_research  = 0;
+    search_stats.futility_cut  = 0;
+    search_stats.playouts      = 0;
+    search_stats.playouts_per_sec = 0;
+    search_stats.reused_visits    = 0;
+    search_stats.tree_nodes       = 0;
+    search_stats.eval_probes      = 0;
+    search_stats.eval_hits        = 0;
+    search_stats.eval_lazy        = 0;
+    for ( tier = 0; tier < EVAL_TIERS; tier++ ) {
+        search_stats.eval_tier_skips[tier] = 0;
+    }
 
     return;
 }
@@ -70,7 +143,9 @@ void init_search_stats(void)
 /**
  * @brief       Builds move tree.
  *
- * Builds a complete move tree recursively.
+ * Builds a complete move tree recursively. If more than one thread is set,
+ * helper threads are started which search the same position and share the
+ * hash table. The move of the main thread is returned.
  *
  * @param[in]   color       Color to move
  * @param[out]  *i_selected Pointer to horizontal coordinate of selected move.
@@ -82,45 +157,46 @@ void search_tree( int color, int *i_selected, int *j_selected )
 {
     // Index variables:
     int k;
-    int d;
-    //int m;   //DEBUG
-    int i, j;
-
-    // Variables for search tree:
-    int depth = 0;
-    int best_value;
-    int search_level_incr;
-    int alpha;
-    int beta;
 
     // Variables for move list:
-    int valid_moves[BOARD_SIZE_MAX * BOARD_SIZE_MAX][4];
+    int (*valid_moves)[4];
     int nr_of_valid_moves;
-    int nr_of_valid_moves_cut;
+
+    // Variables for helper threads:
+    helper_t         helpers[MAX_THREADS];
+    board_snapshot_t snapshot;
+    move_t           last_move;
+    pthread_attr_t   attr;
+    int              nr_of_helpers = 0;
+
+    // Variables for evaluation cache statistics:
+    unsigned long long int eval_probes;
+    unsigned long long int eval_hits;
+    unsigned long long int eval_lazy;
+    unsigned long long int eval_tier_skips[EVAL_TIERS];
+    int tier;
 
     // Variables for measuring time:
-    time_t start;
-    time_t stop;
-    time_t diff_time;
+    struct timespec start;
+    struct timespec stop;
+    long long int   diff_msec;
 
     // Variables needed for logging:
     char x[2];
     char y[3];
 
     // Setting to root level values:
-    alpha = INT_MIN;
-    beta  = INT_MAX;
     hash_hit    = 0;
     alpha_break = 0;
     beta_break  = 0;
-    search_level_incr = 0;
     count_quiet_search = 0;
+    null_cut     = 0;
+    lmr_count    = 0;
+    lmr_research = 0;
+    futility_cut = 0;
+    reset_eval_cache_stats();
 
-    //init_brains();
     init_search_stats();
-    //init_hash_table();
-
-    best_value = ( color == BLACK ) ? INT_MIN : INT_MAX;
 
     node_count = 0;
 
@@ -132,33 +208,214 @@ void search_tree( int color, int *i_selected, int *j_selected )
         }
     }
 
-    (void) time(&start);
+    (void) clock_gettime( CLOCK_MONOTONIC, &start );
+
+    valid_moves       = open_move_list();
+    nr_of_valid_moves = get_valid_move_list( color, valid_moves, true );
+    close_move_list(nr_of_valid_moves);
+
+    // Start helper threads:
+    if ( thread_count > 1 && nr_of_valid_moves > 1 ) {
+        get_board_snapshot(&snapshot);
+        get_last_move(&last_move);
+        __atomic_store_n( &stop_search, 0, __ATOMIC_SEQ_CST );
+
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize( &attr, HELPER_STACK_SIZE );
+        for ( k = 0; k < thread_count - 1; k++ ) {
+            helpers[k].thread_nr = k + 1;
+            helpers[k].color     = color;
+            helpers[k].snapshot  = &snapshot;
+            helpers[k].last_move = &last_move;
+            if ( pthread_create( &helpers[k].thread, &attr, run_helper, &helpers[k] ) != 0 ) {
+                break;
+            }
+            nr_of_helpers++;
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    search_root( color, valid_moves, nr_of_valid_moves, search_depth, 0 );
+
+    // Stop helper threads and collect their statistics:
+    __atomic_store_n( &stop_search, 1, __ATOMIC_SEQ_CST );
+    get_eval_cache_stats( &eval_probes, &eval_hits );
+    get_eval_tier_stats( &eval_lazy, eval_tier_skips );
+    for ( k = 0; k < nr_of_helpers; k++ ) {
+        pthread_join( helpers[k].thread, NULL );
+        node_count         += helpers[k].node_count;
+        count_quiet_search += helpers[k].qsearch_count;
+        hash_hit           += helpers[k].hash_hit;
+        alpha_break        += helpers[k].alpha_cut;
+        beta_break         += helpers[k].beta_cut;
+        null_cut           += helpers[k].null_cut;
+        lmr_count          += helpers[k].lmr_count;
+        lmr_research       += helpers[k].lmr_research;
+        futility_cut       += helpers[k].futility_cut;
+        eval_probes        += helpers[k].eval_probes;
+        eval_hits          += helpers[k].eval_hits;
+        eval_lazy          += helpers[k].eval_lazy;
+        for ( tier = 0; tier < EVAL_TIERS; tier++ ) {
+            eval_tier_skips[tier] += helpers[k].eval_tier_skips[tier];
+        }
+    }
+
+    (void) clock_gettime( CLOCK_MONOTONIC, &stop );
+
+    diff_msec = (long long int)( stop.tv_sec - start.tv_sec ) * 1000
+              + ( stop.tv_nsec - start.tv_nsec ) / 1000000;
+    if ( diff_msec <= 0 ) {
+        diff_msec = 1;
+    }
+
+    // Save some stats about this search:
+    search_stats.color[0] = '\0';
+    if ( color == BLACK ) {
+        my_strcpy( search_stats.color, "Black", 6 );
+    }
+    else {
+        my_strcpy( search_stats.color, "White", 6 );
+    }
+    search_stats.move[0] = '\0';
+    if ( valid_moves[0][0] != INVALID ) {
+        i_to_x( valid_moves[0][0], x );
+        j_to_y( valid_moves[0][1], y );
+        strcat( search_stats.move, x );
+        strcat( search_stats.move, y );
+    }
+    search_stats.level         = search_depth;
+    search_stats.duration      = stop.tv_sec - start.tv_sec;
+    search_stats.node_count    = node_count;
+    search_stats.nodes_per_sec = node_count * 1000 / diff_msec;
+    search_stats.qsearch_count = count_quiet_search;
+    search_stats.hash_hit      = hash_hit;
+    search_stats.alpha_cut     = alpha_break;
+    search_stats.beta_cut      = beta_break;
+    search_stats.value         = valid_moves[0][2];
+    search_stats.threads       = nr_of_helpers + 1;
+    search_stats.null_cut      = null_cut;
+    search_stats.lmr_count     = lmr_count;
+    search_stats.lmr_research  = lmr_research;
+    search_stats.futility_cut  = futility_cut;
+    search_stats.eval_probes   = eval_probes;
+    search_stats.eval_hits     = eval_hits;
+    search_stats.eval_lazy     = eval_lazy;
+    for ( tier = 0; tier < EVAL_TIERS; tier++ ) {
+        search_stats.eval_tier_skips[tier] = eval_tier_skips[tier];
+    }
+
+    // Save best root moves with their principal variations:
+    pv_line_count = ( nr_of_valid_moves < multi_pv ) ? nr_of_valid_moves : multi_pv;
+    for ( k = 0; k < pv_line_count; k++ ) {
+        pv_lines[k].i         = valid_moves[k][0];
+        pv_lines[k].j         = valid_moves[k][1];
+        pv_lines[k].value     = valid_moves[k][2];
+        pv_lines[k].depth     = search_depth;
+        pv_lines[k].pv_length = get_pv_from_hash( color, valid_moves[k][0], valid_moves[k][1], pv_lines[k].pv );
+    }
+
+    *i_selected = valid_moves[0][0];
+    *j_selected = valid_moves[0][1];
+
+    free_move_list(valid_moves);
+
+    if ( log_file != NULL ) {
+        fclose(log_file);
+        log_file = NULL;
+    }
+
+    return;
+}
+
+/**
+ * @brief       Searches the root move list.
+ *
+ * Performs the iterative deepening loop over the given root move list. After
+ * every iteration the move list is sorted by value, the best move first.
+ * Helper threads start with a different root move, so the threads do not
+ * search the same subtrees at the same time.
+ *
+ * @param[in]   color               Color to move
+ * @param[in,out] valid_moves       List of root moves
+ * @param[in]   nr_of_valid_moves   Number of root moves
+ * @param[in]   depth_max           Depth of last iteration
+ * @param[in]   thread_nr           Number of search thread; 0 is main thread
+ * @return      Nothing
+ */
+void search_root( int color, int valid_moves[][4], int nr_of_valid_moves, int depth_max, int thread_nr )
+{
+    // Index variables:
+    int k;
+    int m;
+    int d;
+    int i, j;
+
+    // Variables for search tree:
+    int depth = 0;
+    int best_value;
+    int alpha;
+    int beta;
+    int nr_of_valid_moves_cut;
+    int value;
+    int nth_value;
+    int pv_count = ( thread_nr == 0 ) ? multi_pv : 1;
+
+    // Variables needed for logging:
+    char x[2];
+    char y[3];
+
+    alpha = INT_MIN;
+    beta  = INT_MAX;
+
+    best_value = ( color == BLACK ) ? INT_MIN : INT_MAX;
 
-    nr_of_valid_moves     = get_valid_move_list( color, valid_moves );
     nr_of_valid_moves_cut = nr_of_valid_moves;
 
     // Loop start:
-    search_level_incr = get_search_depth();
-    for ( d = 0; d <= search_level_incr; d++ ) {
-        set_search_depth(d);
-        //set_search_level(search_level_incr);
-        //l = search_level_incr;
+    for ( d = 0; d <= depth_max; d++ ) {
+        max_depth = d;
 
         // Go through move list:
-        for ( k = 0; k < nr_of_valid_moves_cut; k++ ) {
+        for ( m = 0; m < nr_of_valid_moves_cut; m++ ) {
+            k = ( m + thread_nr ) % nr_of_valid_moves_cut;
             i = valid_moves[k][0];
             j = valid_moves[k][1];
 
             // Make move:
             node_count++;
-            //printf( "# Level: %d make: %d,%d value: %d\n", l, i, j, best_value );
             make_move( color, i, j );
-            //i_to_x( i, x );
-            //j_to_y( j, y );
-            //printf( "## %s%s\n", x, y );
 
-            // Start recursion:
-            valid_moves[k][2] = add_node( color * -1, depth, alpha, beta );
+            if ( pv_count == 1 ) {
+                // Start recursion:
+                valid_moves[k][2] = add_node( color * -1, depth, alpha, beta );
+            }
+            else if ( m < pv_count ) {
+                // Multi-PV: the best moves are searched with a full window:
+                valid_moves[k][2] = add_node( color * -1, depth, INT_MIN, INT_MAX );
+            }
+            else {
+                // Multi-PV: all other moves only have to prove that they are
+                // not better than the worst of the best moves. The window
+                // around the n-th value gives the exact value of a move that
+                // ties with it, so ties get into the list as well:
+                nth_value = get_nth_value( color, valid_moves, m, pv_count );
+                if ( nth_value == INT_MIN || nth_value == INT_MAX ) {
+                    value = add_node( color * -1, depth, INT_MIN, INT_MAX );
+                }
+                else {
+                    value = add_node( color * -1, depth, nth_value - 1, nth_value + 1 );
+                    if ( ( color == BLACK && value > nth_value ) || ( color == WHITE && value < nth_value ) ) {
+                        value = add_node( color * -1, depth, INT_MIN, INT_MAX );
+                    }
+                }
+                valid_moves[k][2] = value;
+            }
+
+            undo_move();
+
+            if ( is_search_stopped() ) {
+                return;
+            }
 
             if ( color  == BLACK ) {
                 // For black: remember highest value
@@ -179,14 +436,12 @@ void search_tree( int color, int *i_selected, int *j_selected )
                 }
             }
 
-            if ( do_log ) {
+            if ( do_log && ! is_helper ) {
                 i_to_x( i, x );
                 j_to_y( j, y );
                 fprintf( log_file, "%s%s (%d) (a: %d, b: %d)\n"
                     , x, y, valid_moves[k][2], alpha, beta );
             }
-
-            undo_move();
         }
 
         // Sort move list by value:
@@ -197,59 +452,214 @@ void search_tree( int color, int *i_selected, int *j_selected )
             qsort( valid_moves, (size_t)nr_of_valid_moves_cut, sizeof(valid_moves[0]), compare_value_white );
         }
 
-        // DEBUG:
-        /*
-        printf( "# Level: %d (%d) - ", l, nr_of_valid_moves_cut );
-        for ( m = 0; m < nr_of_valid_moves_cut; m++ ) {
-            i_to_x( valid_moves[m][0], x );
-            j_to_y( valid_moves[m][1], y );
-            printf( "%s%s (%d,%d), ", x, y, valid_moves[m][2], valid_moves[m][3] );
-        }
-        printf("\n");
-        */
-
-        if ( nr_of_valid_moves_cut / 2 > 5 ) {
+        if ( nr_of_valid_moves_cut / 2 > 5 && nr_of_valid_moves_cut / 2 >= pv_count ) {
             nr_of_valid_moves_cut = nr_of_valid_moves_cut / 2;
         }
 
     }
     // Loop end
 
-    (void) time(&stop);
+    return;
+}
 
-    diff_time = stop - start;
-    if ( diff_time == 0 ) {
-        diff_time = 1;
+/**
+ * @brief       Returns the n-th best value of a move list.
+ *
+ * Looks at the first count moves of the move list and returns the n-th best
+ * value for the given color.
+ *
+ * @param[in]   color       Color to move
+ * @param[in]   valid_moves List of moves with values
+ * @param[in]   count       Number of moves to look at
+ * @param[in]   n           Rank of value, starting with 1
+ * @return      n-th best value
+ */
+int get_nth_value( int color, int valid_moves[][4], int count, int n )
+{
+    int k, l;
+    int value;
+    int best[MAX_MULTI_PV];
+    int nr_of_best = 0;
+
+    // Keep the n best values sorted, best first:
+    for ( k = 0; k < count; k++ ) {
+        value = valid_moves[k][2];
+        for ( l = nr_of_best; l > 0; l-- ) {
+            if ( ( color == BLACK && best[l-1] >= value ) || ( color == WHITE && best[l-1] <= value ) ) {
+                break;
+            }
+            if ( l < n ) {
+                best[l] = best[l-1];
+            }
+        }
+        if ( l < n ) {
+            best[l] = value;
+            if ( nr_of_best < n ) {
+                nr_of_best++;
+            }
+        }
     }
 
-    // Save some stats about this search:
-    search_stats.color[0] = '\0';
-    if ( color == BLACK ) {
-        my_strcpy( search_stats.color, "Black", 6 );
+    return best[nr_of_best - 1];
+}
+
+/**
+ * @brief       Gets the principal variation of a root move from hash table.
+ *
+ * Makes the root move and follows the best moves stored in the hash table as
+ * long as they are valid. All moves are taken back afterwards.
+ *
+ * @param[in]   color   Color of root move
+ * @param[in]   i       Horizontal coordinate of root move
+ * @param[in]   j       Vertical coordinate of root move
+ * @param[out]  pv      Principal variation, starting with root move
+ * @return      Number of moves in principal variation
+ */
+int get_pv_from_hash( int color, int i, int j, int pv[][2] )
+{
+    int k;
+    int length = 0;
+    hash_entry_t entry;
+
+    if ( i == INVALID ) {
+        return 0;
     }
-    else {
-        my_strcpy( search_stats.color, "White", 6 );
+
+    make_move( color, i, j );
+    pv[length][0] = i;
+    pv[length][1] = j;
+    length++;
+    color *= -1;
+
+    while ( length < MAX_PV_LENGTH ) {
+        if ( ! probe_hash_table( get_hash_id() ^ get_hash_color(color), &entry ) ) {
+            break;
+        }
+        if ( entry.i == INVALID || ! is_legal_move( color, entry.i, entry.j )
+                || is_move_ko( color, entry.i, entry.j ) ) {
+            break;
+        }
+
+        make_move( color, entry.i, entry.j );
+        pv[length][0] = entry.i;
+        pv[length][1] = entry.j;
+        length++;
+        color *= -1;
     }
-    i_to_x( valid_moves[0][0], x );
-    j_to_y( valid_moves[0][1], y );
-    search_stats.move[0] = '\0';
-    strcat( search_stats.move, x );
-    strcat( search_stats.move, y );
-    search_stats.level         = search_depth;
-    search_stats.duration      = stop - start;
-    search_stats.node_count    = node_count;
-    search_stats.nodes_per_sec = node_count / diff_time;
-    search_stats.qsearch_count = count_quiet_search;
-    search_stats.hash_hit      = hash_hit;
-    search_stats.alpha_cut     = alpha_break;
-    search_stats.beta_cut      = beta_break;
-    search_stats.value         = valid_moves[0][2];
 
-    *i_selected = valid_moves[0][0];
-    *j_selected = valid_moves[0][1];
+    for ( k = 0; k < length; k++ ) {
+        undo_move();
+    }
 
-    if ( log_file != NULL ) {
-        fclose(log_file);
+    return length;
+}
+
+/**
+ * @brief       Main function of a helper search thread.
+ *
+ * Sets up the position on the board of the helper thread and searches it
+ * until the main thread has finished. Odd numbered helpers search one level
+ * deeper than the main thread.
+ *
+ * @param[in]   arg     Pointer to helper_t struct of this thread
+ * @return      NULL
+ */
+void *run_helper( void *arg )
+{
+    helper_t *helper = (helper_t *)arg;
+    int (*valid_moves)[4];
+    int nr_of_valid_moves;
+
+    is_helper          = true;
+    node_count         = 0;
+    count_quiet_search = 0;
+    hash_hit           = 0;
+    alpha_break        = 0;
+    beta_break         = 0;
+    null_cut           = 0;
+    lmr_count          = 0;
+    lmr_research       = 0;
+    futility_cut       = 0;
+    reset_eval_cache_stats();
+
+    set_board_snapshot( helper->snapshot );
+    set_move_history_base( helper->last_move );
+
+    valid_moves       = open_move_list();
+    nr_of_valid_moves = get_valid_move_list( helper->color, valid_moves, true );
+    close_move_list(nr_of_valid_moves);
+    search_root( helper->color, valid_moves, nr_of_valid_moves
+        , search_depth + ( helper->thread_nr % 2 ), helper->thread_nr );
+
+    helper->node_count    = node_count;
+    helper->qsearch_count = count_quiet_search;
+    helper->hash_hit      = hash_hit;
+    helper->alpha_cut     = alpha_break;
+    helper->beta_cut      = beta_break;
+    helper->null_cut      = null_cut;
+    helper->lmr_count     = lmr_count;
+    helper->lmr_research  = lmr_research;
+    helper->futility_cut  = futility_cut;
+    get_eval_cache_stats( &helper->eval_probes, &helper->eval_hits );
+    get_eval_tier_stats( &helper->eval_lazy, helper->eval_tier_skips );
+
+    free_move_stack();
+    free_move_history();
+    free_board();
+
+    return NULL;
+}
+
+/**
+ * @brief       Checks if a helper thread has to stop.
+ *
+ * Returns true if the calling thread is a helper thread and the main thread
+ * has finished its search. The main thread is never stopped.
+ *
+ * @return      true|false
+ */
+bool is_search_stopped(void)
+{
+
+    return is_helper && __atomic_load_n( &stop_search, __ATOMIC_RELAXED );
+}
+
+/**
+ * @brief       Moves given move to the front of the move list.
+ *
+ * Moves the given vertex to the first position of the move list. The order
+ * of the other moves is kept. Nothing happens if the move is not found.
+ *
+ * @param[in,out] valid_moves       List of moves
+ * @param[in]   nr_of_valid_moves   Number of moves
+ * @param[in]   i                   Horizontal coordinate
+ * @param[in]   j                   Vertical coordinate
+ * @return      Nothing
+ */
+void move_to_front( int valid_moves[][4], int nr_of_valid_moves, int i, int j )
+{
+    int k, l;
+    int move[4];
+
+    for ( k = 0; k < nr_of_valid_moves; k++ ) {
+        if ( valid_moves[k][0] == i && valid_moves[k][1] == j ) {
+            break;
+        }
+    }
+    if ( k == 0 || k == nr_of_valid_moves ) {
+        return;
+    }
+
+    for ( l = 0; l < 4; l++ ) {
+        move[l] = valid_moves[k][l];
+    }
+    for ( ; k > 0; k-- ) {
+        for ( l = 0; l < 4; l++ ) {
+            valid_moves[k][l] = valid_moves[k-1][l];
+        }
+    }
+    for ( l = 0; l < 4; l++ ) {
+        valid_moves[0][l] = move[l];
     }
 
     return;
@@ -260,7 +670,13 @@ void search_tree( int color, int *i_selected, int *j_selected )
  *
  * A new node is added to the move tree. For every move in the generated move
  * list, a new node is added recursively. If a certain level is reached, the
- * recusrion is stopped.
+ * recusrion is stopped and the moves of the last level are resolved by
+ * qsearch().
+ *
+ * The selective techniques switched on by set_selective() are applied here:
+ * null move pruning before the move list is searched, late move reductions
+ * for moves at the end of the ordered move list and futility pruning at the
+ * last level.
  *
  * @param[in]   color       Color of move to set.
  * @param[in]   depth       Counter that shows the level in the move tree.
@@ -272,51 +688,100 @@ int add_node( int color, int depth, int alpha, int beta )
 {
     int  k, l;
     int  i, j;
-    int  valid_moves[BOARD_SIZE_MAX * BOARD_SIZE_MAX][4];
+    int  (*valid_moves)[4];
     int  nr_of_valid_moves;
     int  best_value;
     char x[2];
     char y[3];
     char indent[10];
-    int  tactic_move = 0;
-    int  qsearch = MAX_QSEARCH_DEPTH;
-    //unsigned hash_id;
+    int  alpha_start = alpha;
+    int  beta_start  = beta;
+    int  remaining;
+    int  best_i = INVALID;
+    int  best_j = INVALID;
+    int  value;
+    hash_t hash_id = 0;
+    hash_entry_t entry;
     int value_list[COUNT_BRAINS] = { 1, 2, 3, 4, 5, 6, 7, 8 };
 
+    if ( is_search_stopped() ) {
+        return 0;
+    }
 
     best_value = ( color == BLACK ) ? INT_MIN : INT_MAX;
-    if ( ! ( ( search_depth + MAX_QSEARCH_DEPTH ) % 2 ) ) {
-        qsearch++;
-    }
 
     depth++;
+    remaining = max_depth - depth;
+
+    // Look up position in hash table:
+    entry.i = INVALID;
+    entry.j = INVALID;
+    if ( remaining >= 0 ) {
+        hash_id = get_hash_id() ^ get_hash_color(color);
+        if ( probe_hash_table( hash_id, &entry ) && entry.depth >= remaining ) {
+            if ( entry.flag == HASH_EXACT
+                || ( entry.flag == HASH_LOWER && entry.value >= beta  )
+                || ( entry.flag == HASH_UPPER && entry.value <= alpha ) ) {
+                hash_hit++;
+                return entry.value;
+            }
+        }
+    }
+
+    // Null move pruning: if the position is still good enough for a cut-off
+    // after a pass, the cut-off is verified by a search with reduced depth:
+    if ( ( selective & SELECT_NULL_MOVE ) && ! in_null_verify
+            && remaining > NULL_MOVE_REDUCTION && ! get_last_move_pass() ) {
+        make_move( color, INVALID, INVALID );
+        value = add_node( color * -1, depth + NULL_MOVE_REDUCTION, alpha, beta );
+        undo_move();
+
+        if ( ( color == BLACK && value > beta ) || ( color == WHITE && value < alpha ) ) {
+            in_null_verify = true;
+            value = add_node( color, depth - 1 + NULL_MOVE_REDUCTION, alpha, beta );
+            in_null_verify = false;
+
+            if ( ( color == BLACK && value > beta ) || ( color == WHITE && value < alpha ) ) {
+                null_cut++;
+                return value;
+            }
+        }
+    }
+
+    valid_moves       = open_move_list();
+    nr_of_valid_moves = get_valid_move_list( color, valid_moves, false );
+    close_move_list(nr_of_valid_moves);
 
-    nr_of_valid_moves = get_valid_move_list( color, valid_moves );
+    // Search best move of hash table first:
+    if ( entry.i != INVALID ) {
+        move_to_front( valid_moves, nr_of_valid_moves, entry.i, entry.j );
+    }
 
     // PASS if no valid move is possible:
     if ( nr_of_valid_moves == 0 ) {
         make_move( color, INVALID, INVALID );
-        best_value = evaluate_position( value_list, false );
+        best_value = evaluate_position(value_list);
         undo_move();
     }
 
-    // Count tactic moves:
-    for ( l = 0; l < nr_of_valid_moves; l++ ) {
-        if ( valid_moves[l][3] > 0 ) {
-            tactic_move++;
-        }
-    }
-
     // Go through move list:
     for ( k = 0; k < nr_of_valid_moves; k++ ) {
         i = valid_moves[k][0];
         j = valid_moves[k][1];
 
-        // Skip non-tactical moves in quiescense search:
-        if ( depth >= search_depth && tactic_move > 0) {
-            if ( valid_moves[k][3] == 0 ) {
-                continue;
+        // Futility pruning: at the last level a quiet move whose ordering
+        // value is far below alpha (or above beta for white) is not searched.
+        // It fails low with its optimistic bound and never becomes best move:
+        if ( ( selective & SELECT_FUTILITY ) && depth >= max_depth && valid_moves[k][3] == 0
+                && ( ( color == BLACK && valid_moves[k][2] + FUTILITY_MARGIN <= alpha )
+                  || ( color == WHITE && valid_moves[k][2] - FUTILITY_MARGIN >= beta ) ) ) {
+            futility_cut++;
+            value = valid_moves[k][2] + color * FUTILITY_MARGIN;
+            if ( ( color == BLACK && value > best_value )
+                    || ( color == WHITE && value < best_value ) ) {
+                best_value = value;
             }
+            continue;
         }
 
         // Make move:
@@ -324,25 +789,36 @@ int add_node( int color, int depth, int alpha, int beta )
         make_move( color, i, j );
 
 
-        if ( depth < search_depth ) {
-            // Start recursion:
-            valid_moves[k][2] = add_node( color * -1, depth, alpha, beta );
-        }
-        else {
-            //insert_hash_table( hash_id, best_value );
-            if ( tactic_move && depth < search_depth + qsearch ) {
-                valid_moves[k][2] = add_node( color * -1, depth, alpha, beta );
-                count_quiet_search++;
+        if ( depth < max_depth ) {
+            // Late move reduction: quiet moves at the end of the ordered
+            // move list are searched one level less. If such a move turns out
+            // to be better than expected, it is searched again:
+            if ( ( selective & SELECT_LMR ) && k >= LMR_FULL_MOVES
+                    && remaining >= 2 && valid_moves[k][3] == 0 ) {
+                lmr_count++;
+                value = add_node( color * -1, depth + 1, alpha, beta );
+                if ( ( color == BLACK && value > alpha ) || ( color == WHITE && value < beta ) ) {
+                    lmr_research++;
+                    value = add_node( color * -1, depth, alpha, beta );
+                }
             }
             else {
-                valid_moves[k][2] = evaluate_position( value_list, true );
+                // Start recursion:
+                value = add_node( color * -1, depth, alpha, beta );
             }
+            valid_moves[k][2] = value;
+        }
+        else {
+            // Resolve tactics of last level:
+            valid_moves[k][2] = qsearch( color * -1, 0, alpha, beta );
         }
 
         if ( color  == BLACK ) {
             // For black: remember highest value
             if ( valid_moves[k][2] > best_value ) {
                 best_value = valid_moves[k][2];
+                best_i     = i;
+                best_j     = j;
                 if ( best_value > alpha ) {
                     alpha = best_value;
                 }
@@ -352,13 +828,15 @@ int add_node( int color, int depth, int alpha, int beta )
             // For white: remember lowest value
             if ( valid_moves[k][2] < best_value ) {
                 best_value = valid_moves[k][2];
+                best_i     = i;
+                best_j     = j;
                 if ( best_value < beta ) {
                     beta = best_value;
                 }
             }
         }
 
-        if ( do_log ) {
+        if ( do_log && ! is_helper ) {
             i_to_x( i, x );
             j_to_y( j, y );
             indent[0] = '\0';
@@ -389,6 +867,118 @@ int add_node( int color, int depth, int alpha, int beta )
         }
     }
 
+    // Store result in hash table, unless the search has been stopped:
+    if ( remaining >= 0 && nr_of_valid_moves > 0 && ! is_search_stopped() ) {
+        if ( best_value <= alpha_start ) {
+            store_hash_table( hash_id, remaining, HASH_UPPER, best_value, best_i, best_j );
+        }
+        else if ( best_value >= beta_start ) {
+            store_hash_table( hash_id, remaining, HASH_LOWER, best_value, best_i, best_j );
+        }
+        else {
+            store_hash_table( hash_id, remaining, HASH_EXACT, best_value, best_i, best_j );
+        }
+    }
+
+    free_move_list(valid_moves);
+
+    return best_value;
+}
+
+/**
+ * @brief       Searches tactical moves until the position is quiet.
+ *
+ * The side to move may stand pat, i.e. accept the static evaluation of the
+ * position, or try one of the moves of get_tactical_move_list(). Only
+ * captures, atari escapes and ataris are searched, so the tactics at the
+ * end of the move tree are resolved without generating the full move list.
+ * The search ends after MAX_QSEARCH_DEPTH moves.
+ *
+ * @param[in]   color       Color to move.
+ * @param[in]   qdepth      Number of tactical moves made so far.
+ * @param[in]   alpha       Alpha-Beta pruning
+ * @param[in]   beta        Alpha-Beta pruning
+ * @return      Value of position
+ * @note        Must be called directly after make_move(), because the move
+ *              generator needs the worm data of the current position.
+ */
+int qsearch( int color, int qdepth, int alpha, int beta )
+{
+    int k;
+    int value;
+    int best_value;
+    int (*tactical_moves)[4];
+    int nr_of_tactical_moves;
+    int value_list[COUNT_BRAINS];
+
+    count_quiet_search++;
+
+    if ( is_search_stopped() ) {
+        return 0;
+    }
+
+    // Stand pat, expensive brains are skipped far outside of the window:
+    best_value = evaluate_position_window( value_list, alpha, beta );
+    if ( qdepth >= MAX_QSEARCH_DEPTH ) {
+        return best_value;
+    }
+    if ( color == BLACK ) {
+        if ( best_value > beta ) {
+            beta_break++;
+            return best_value;
+        }
+        if ( best_value > alpha ) {
+            alpha = best_value;
+        }
+    }
+    else {
+        if ( best_value < alpha ) {
+            alpha_break++;
+            return best_value;
+        }
+        if ( best_value < beta ) {
+            beta = best_value;
+        }
+    }
+
+    tactical_moves       = open_move_list();
+    nr_of_tactical_moves = get_tactical_move_list( color, tactical_moves );
+    close_move_list(nr_of_tactical_moves);
+
+    for ( k = 0; k < nr_of_tactical_moves; k++ ) {
+        node_count++;
+        make_move( color, tactical_moves[k][0], tactical_moves[k][1] );
+        value = qsearch( color * -1, qdepth + 1, alpha, beta );
+        undo_move();
+
+        if ( color == BLACK ) {
+            if ( value > best_value ) {
+                best_value = value;
+                if ( best_value > alpha ) {
+                    alpha = best_value;
+                }
+            }
+            if ( value > beta ) {
+                beta_break++;
+                break;
+            }
+        }
+        else {
+            if ( value < best_value ) {
+                best_value = value;
+                if ( best_value < beta ) {
+                    beta = best_value;
+                }
+            }
+            if ( value < alpha ) {
+                alpha_break++;
+                break;
+            }
+        }
+    }
+
+    free_move_list(tactical_moves);
+
     return best_value;
 }
 
@@ -409,7 +999,6 @@ void make_move( int color, int i, int j )
     int group_nr;
     int nr_of_liberties;
     int group_size;
-    int captured_now[BOARD_SIZE_MAX * BOARD_SIZE_MAX][2];
 
     // Check for pass:
     if ( i == INVALID && j == INVALID ) {
@@ -427,11 +1016,9 @@ void make_move( int color, int i, int j )
         scan_board_1();
     }
 
-    nr_of_removed_stones = get_captured_now(captured_now);
-
     create_next_move();
     set_move_vertex( color, i, j );
-    set_move_captured_stones(captured_now);
+    nr_of_removed_stones = set_move_captured_now();
 
     group_nr        = get_worm_nr( i, j );
     nr_of_liberties = get_nr_of_liberties(group_nr);
@@ -440,8 +1027,8 @@ void make_move( int color, int i, int j )
     // Check if this move is a ko:
     if ( nr_of_removed_stones == 1 && group_size == 1 && nr_of_liberties == 1 ) {
         // If only one stone has been captured it must be the first in the
-        // captured_now list:
-        set_move_ko( captured_now[0][0], captured_now[0][1] );
+        // list of captured stones:
+        set_move_ko( next_move.stones[0][0], next_move.stones[0][1] );
     }
 
     push_move();
@@ -464,7 +1051,7 @@ void undo_move(void)
     int j            = get_last_move_j();
     int color        = get_last_move_color();
     int count_stones = get_last_move_count_stones();
-    int stones[BOARD_SIZE_MAX * BOARD_SIZE_MAX][2];
+    int stone[2];
 
     if ( get_last_move_pass() ) {
         pop_move();
@@ -472,12 +1059,11 @@ void undo_move(void)
         return;
     }
 
-    get_last_move_stones(stones);
-
     set_vertex( EMPTY, i, j );
     if ( count_stones > 0 ) {
         for ( k = 0; k < count_stones; k++ ) {
-            set_vertex( color * -1, stones[k][0], stones[k][1] );
+            get_last_move_stone( k, stone );
+            set_vertex( color * -1, stone[0], stone[1] );
         }
 
         if ( color == BLACK ) {
@@ -522,11 +1108,126 @@ int get_search_depth(void)
     return search_depth;
 }
 
+/**
+ * @brief       Sets number of search threads.
+ *
+ * Determines the number of threads that search a position at the same time.
+ *
+ * @param[in]   count   Number of threads (1 to MAX_THREADS)
+ * @return      Nothing
+ */
+void set_thread_count( int count )
+{
+
+    thread_count = count;
+
+    return;
+}
+
+/**
+ * @brief       Returns number of search threads.
+ *
+ * Returns the currently set number of search threads.
+ *
+ * @return      Number of threads
+ */
+int get_thread_count(void)
+{
+
+    return thread_count;
+}
+
+/**
+ * @brief       Switches a selective search technique on or off.
+ *
+ * The techniques SELECT_NULL_MOVE, SELECT_LMR and SELECT_FUTILITY may be
+ * used in any combination. All are switched off by default.
+ *
+ * @param[in]   technique   SELECT_NULL_MOVE|SELECT_LMR|SELECT_FUTILITY
+ * @param[in]   is_on       true|false
+ * @return      Nothing
+ */
+void set_selective( int technique, bool is_on )
+{
+
+    if ( is_on ) {
+        selective |= technique;
+    }
+    else {
+        selective &= ~technique;
+    }
+
+    return;
+}
+
+/**
+ * @brief       Returns if a selective search technique is switched on.
+ *
+ * @param[in]   technique   SELECT_NULL_MOVE|SELECT_LMR|SELECT_FUTILITY
+ * @return      true|false
+ */
+bool get_selective( int technique )
+{
+
+    return ( selective & technique ) != 0;
+}
+
+/**
+ * @brief       Sets number of root moves with exact value.
+ *
+ * With a count greater than one, the search determines the exact value of
+ * the best count root moves (multi-PV). The other moves are only searched
+ * until they prove to be worse.
+ *
+ * @param[in]   count   Number of moves (1 to MAX_MULTI_PV)
+ * @return      Nothing
+ */
+void set_multi_pv( int count )
+{
+
+    multi_pv = count;
+
+    return;
+}
+
+/**
+ * @brief       Returns number of root moves with exact value.
+ *
+ * @return      Number of moves
+ */
+int get_multi_pv(void)
+{
+
+    return multi_pv;
+}
+
+/**
+ * @brief       Returns the best root moves of the last search.
+ *
+ * Copies the best root moves of the last search with their values and
+ * principal variations, best first. The number of moves is the multi-PV
+ * setting or less, if there were fewer valid moves.
+ *
+ * @param[out]  lines   List of at least MAX_MULTI_PV entries
+ * @return      Number of entries
+ */
+int get_pv_lines( pv_line_t lines[] )
+{
+    int k;
+
+    for ( k = 0; k < pv_line_count; k++ ) {
+        lines[k] = pv_lines[k];
+    }
+
+    return pv_line_count;
+}
+
 /**
  * @brief       Helper function for qsort().
  *
  * This is a helper function for qsort(), that makes it possible to sort the
- * move list by move value. The best move for black is sorted first.
+ * move list by move value. The best move for black is sorted first. Moves
+ * with the same value are sorted by the weight of their 3x3 pattern.
  *
  * @param[in]   move1   Pointer to first move
  * @param[in]   move2   Pointer to second move
@@ -542,14 +1243,15 @@ int compare_value_black( const void *move1, const void *move2 )
         return 1;
     }
 
-    return 0;
+    return compare_pattern( BLACK, move1, move2 );
 }
 
 /**
  * @brief       Helper function for qsort().
  *
  * This is a helper function for qsort(), that makes it possible to sort the
- * move list by move value. The best move for white is sorted first.
+ * move list by move value. The best move for white is sorted first. Moves
+ * with the same value are sorted by the weight of their 3x3 pattern.
  *
  * @param[in]   move1   Pointer to first move
  * @param[in]   move2   Pointer to second move
@@ -565,6 +1267,30 @@ int compare_value_white( const void *move1, const void *move2 )
         return -1;
     }
 
+    return compare_pattern( WHITE, move1, move2 );
+}
+
+/**
+ * @brief       Compares two moves by the weight of their 3x3 pattern.
+ *
+ * @param[in]   color   Color to move
+ * @param[in]   move1   Pointer to first move
+ * @param[in]   move2   Pointer to second move
+ * @return      1|0|-1
+ * @note        The moves must not be made on the board.
+ */
+int compare_pattern( int color, const void *move1, const void *move2 )
+{
+    int weight1 = get_pattern_weight( color, get_pattern( ((int *)move1)[0], ((int *)move1)[1] ) );
+    int weight2 = get_pattern_weight( color, get_pattern( ((int *)move2)[0], ((int *)move2)[1] ) );
+
+    if ( weight1 > weight2 ) {
+        return -1;
+    }
+    else if ( weight1 < weight2 ) {
+        return 1;
+    }
+
     return 0;
 }
 
@@ -613,3 +1339,20 @@ search_stats_t get_search_stats(void)
     return search_stats;
 }
 
+
+/**
+ * @brief       Sets search statistics.
+ *
+ * Stores the statistics of a search done by another engine, so they are
+ * reported the same way as the statistics of search_tree().
+ *
+ * @param[in]   stats   Search statistics
+ * @return      Nothing
+ */
+void set_search_stats( const search_stats_t *stats )
+{
+
+    search_stats = *stats;
+
+    return;
+}
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <time.h>
+#include "global_const.h"
 
 /**
  *  @file   search.h
@@ -11,6 +12,10 @@
  *
  */
 
+#define SELECT_NULL_MOVE    1   //!< Null move (pass) pruning with verification.
+#define SELECT_LMR          2   //!< Late move reductions.
+#define SELECT_FUTILITY     4   //!< Futility pruning at frontier nodes.
+
 /**
  * @brief   Structure that stores information about last generated move.
  *
@@ -27,13 +32,49 @@ typedef struct {
     int alpha_cut;                          //!< Number of alpha cut-offs;
     int beta_cut;                           //!< Number of beta cut-offs;
     int value;                              //!< Value of move;
+    int threads;                            //!< Number of search threads used.
+    int null_cut;                           //!< Number of verified null move cut-offs.
+    int lmr_count;                          //!< Number of reduced late moves.
+    int lmr_research;                       //!< Number of reduced moves searched again.
+    int futility_cut;                       //!< Number of moves pruned by futility.
+    int playouts;                           //!< Number of Monte Carlo playouts.
+    unsigned long long int playouts_per_sec;    //!< Number of Monte Carlo playouts per second.
+    int reused_visits;                      //!< Number of visits kept from the previous search tree.
+    unsigned int tree_nodes;                //!< Number of nodes of the search tree after the search.
+    unsigned long long int eval_probes;     //!< Number of lookups in the evaluation cache.
+    unsigned long long int eval_hits;       //!< Number of hits in the evaluation cache.
+    unsigned long long int eval_lazy;       //!< Number of evaluations with window that missed the cache.
+    unsigned long long int eval_tier_skips[EVAL_TIERS]; //!< Number of evaluations with window that skipped a tier.
 } search_stats_t;
 
+/**
+ * @brief   Structure that stores a root move with its principal variation.
+ *
+ **/
+typedef struct {
+    int i;                          //!< Horizontal coordinate of root move.
+    int j;                          //!< Vertical coordinate of root move.
+    int value;                      //!< Value of root move.
+    int depth;                      //!< Search depth of value.
+    int pv_length;                  //!< Number of moves in principal variation.
+    int pv[MAX_PV_LENGTH][2];       //!< Principal variation, starting with root move.
+} pv_line_t;
+
 void search_tree( int color, int *i, int *j );
 
 void set_search_depth( int depth );
 int  get_search_depth(void);
 
+void set_thread_count( int count );
+int  get_thread_count(void);
+
+void set_selective( int technique, bool is_on );
+bool get_selective( int technique );
+
+void set_multi_pv( int count );
+int  get_multi_pv(void);
+int  get_pv_lines( pv_line_t lines[] );
+
 bool get_do_log(void);
 void set_do_log(void);
 
@@ -42,6 +83,7 @@ int compare_value_white( const void *move1, const void *move2 );
 
 void init_search_stats(void);
 search_stats_t get_search_stats(void);
+void set_search_stats( const search_stats_t *stats );
 
 #endif
 
@@ -31,9 +31,22 @@ my @known_commands = qw{
     genmove
     undo
     loadsgf
+    final_score
     hg-log
     hg-stats
     hg-factors
+    hg-threads
+    hg-selective
+    hg-multipv
+    hg-analyze
+    hg-engine
+    hg-playouts
+    hg-rave
+    hg-ponder
+    hg-memory
+    hg-bouzy
+    hg-network
+    hg-estimate
     showgroups
 };
 
@@ -2,12 +2,17 @@
 #include <stdlib.h>
 #include <strings.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <check.h>
 #include "../src/global_const.h"
 #include "../src/board_intern.h"
 #include "../src/board.h"
 #include "../src/move.h"
 #include "../src/evaluate.h"
+#include "../src/influence.h"
+#include "../src/network.h"
+#include "../src/eyes.h"
+#include "../src/pattern.h"
 
 
 static const int board_count  = 5;
@@ -618,6 +623,491 @@ START_TEST (test_atari_1)
 }
 END_TEST
 
+START_TEST (test_worm_liberties_1)
+{
+    int liberties[BOARD_SIZE_MAX * BOARD_SIZE_MAX][3];
+    int count;
+
+    init_board(5);
+
+    set_vertex( BLACK, 0, 0 );
+    set_vertex( WHITE, 1, 0 );
+    scan_board_1();
+
+    count = get_worm_liberties( BLACK, 1, liberties );
+    fail_unless( count == 1, "one liberty of black worm in atari (%d)", count );
+    fail_unless( liberties[0][0] == 0 && liberties[0][1] == 1, "liberty is 0,1" );
+    fail_unless( liberties[0][2] == 1, "worm size is 1" );
+
+    count = get_worm_liberties( WHITE, 2, liberties );
+    fail_unless( count == 2, "two liberties of white worm (%d)", count );
+
+    count = get_worm_liberties( WHITE, 1, liberties );
+    fail_unless( count == 0, "no white worm in atari (%d)", count );
+
+    init_board(5);
+
+    set_vertex( BLACK, 1, 0 );
+    set_vertex( BLACK, 0, 1 );
+    scan_board_1();
+
+    fail_unless( ! is_legal_move( WHITE, 0, 0 ), "white suicide on 0,0" );
+    fail_unless( is_legal_move( BLACK, 0, 0 ), "black may play on 0,0" );
+    fail_unless( ! is_legal_move( BLACK, 1, 0 ), "vertex is not empty" );
+}
+END_TEST
+
+START_TEST (test_hash_id_1)
+{
+    int board_size = 5;
+    hash_t empty_id;
+    hash_t hash_id;
+
+    init_board(board_size);
+
+    empty_id = get_hash_id();
+
+    set_vertex( BLACK, 1, 1 );
+    hash_id = get_hash_id();
+    fail_unless( hash_id != empty_id, "hash id changed by stone" );
+
+    set_vertex( WHITE, 1, 1 );
+    fail_unless( get_hash_id() != hash_id, "hash id depends on color" );
+
+    set_vertex( EMPTY, 1, 1 );
+    fail_unless( get_hash_id() == empty_id, "hash id restored" );
+
+    // Captured stones are removed from hash id:
+    set_vertex( BLACK, 1, 0 );
+    set_vertex( BLACK, 0, 1 );
+    hash_id = get_hash_id();
+    set_vertex( WHITE, 0, 0 );
+    scan_board_1();
+    remove_stones(WHITE);
+    set_black_captured(0);
+    fail_unless( get_vertex( 0, 0 ) == EMPTY, "white stone captured" );
+    fail_unless( get_hash_id() == hash_id, "hash id without captured stone" );
+
+    free_board();
+}
+END_TEST
+
+START_TEST (test_snapshot_1)
+{
+    int board_size = 9;
+    board_snapshot_t snapshot;
+
+    init_board(board_size);
+
+    set_vertex( BLACK, 2, 2 );
+    set_vertex( WHITE, 3, 2 );
+    set_black_captured(3);
+    set_white_captured(1);
+
+    get_board_snapshot(&snapshot);
+
+    fail_unless( snapshot.board_size == board_size, "snapshot board size" );
+
+    free_board();
+    init_board(BOARD_SIZE_MIN);
+
+    set_board_snapshot(&snapshot);
+
+    fail_unless( get_board_size()        == board_size, "board size restored" );
+    fail_unless( get_vertex( 2, 2 )      == BLACK,      "black stone restored" );
+    fail_unless( get_vertex( 3, 2 )      == WHITE,      "white stone restored" );
+    fail_unless( get_vertex( 4, 4 )      == EMPTY,      "empty vertex restored" );
+    fail_unless( get_black_captured()    == 3,          "black captured restored" );
+    fail_unless( get_white_captured()    == 1,          "white captured restored" );
+
+    free_board();
+}
+END_TEST
+
+START_TEST (test_pattern_1)
+{
+    int board_size = 5;
+    unsigned short corner;
+
+    init_board(board_size);
+
+    // Directions: N, NE, E, SE, S, SW, W, NW
+    corner = PATTERN_OFF | PATTERN_OFF << 2 | PATTERN_OFF << 10 | PATTERN_OFF << 12 | PATTERN_OFF << 14;
+    fail_unless( get_pattern( 2, 2 ) == 0, "empty pattern" );
+    fail_unless( get_pattern( 0, 0 ) == corner, "corner pattern" );
+
+    set_vertex( BLACK, 1, 1 );
+    fail_unless( get_pattern( 2, 2 ) == PATTERN_BLACK << 14, "black stone in north west" );
+    fail_unless( get_pattern( 0, 0 ) == ( corner | PATTERN_BLACK << 6 ), "black stone in south east" );
+
+    // Capture and restore a white stone:
+    set_vertex( WHITE, 0, 0 );
+    set_vertex( BLACK, 1, 0 );
+    set_vertex( BLACK, 0, 1 );
+    scan_board_1();
+    remove_stones(WHITE);
+    fail_unless( get_pattern( 1, 1 ) == ( PATTERN_BLACK | PATTERN_BLACK << 12 ), "white stone removed" );
+    restore_stones(WHITE);
+    fail_unless( get_pattern( 1, 1 ) == ( PATTERN_BLACK | PATTERN_WHITE << 14 | PATTERN_BLACK << 12 ), "white stone restored" );
+
+    // Capture by the incremental scan, which removes the worm itself:
+    set_vertex( EMPTY, 0, 1 );
+    scan_board_1();
+    set_vertex( BLACK, 0, 1 );
+    scan_board_1_upd( 0, 1 );
+    fail_unless( get_vertex( 0, 0 ) == EMPTY, "white stone captured" );
+    fail_unless( get_pattern( 1, 1 ) == ( PATTERN_BLACK | PATTERN_BLACK << 12 ), "pattern after incremental capture" );
+
+    free_board();
+}
+END_TEST
+
+START_TEST (test_evaluate_batch_1)
+{
+    int n;
+    int values[3];
+    int value_list[COUNT_BRAINS];
+    board_snapshot_t snapshots[3];
+
+    init_board(9);
+    init_brains();
+    set_factor( 1, 1 );     // Atari, no batch function
+    set_factor( 3, 2 );     // Edge stones
+
+    set_vertex( BLACK, 0, 4 );
+    get_board_snapshot(&snapshots[0]);
+    set_vertex( WHITE, 8, 8 );
+    set_vertex( WHITE, 8, 7 );
+    set_black_captured(2);
+    get_board_snapshot(&snapshots[1]);
+    set_vertex( BLACK, 4, 4 );
+    set_white_captured(5);
+    get_board_snapshot(&snapshots[2]);
+
+    evaluate_positions( snapshots, 3, values );
+
+    fail_unless( get_vertex( 4, 4 ) == BLACK && get_white_captured() == 5, "board unchanged" );
+    for ( n = 0; n < 3; n++ ) {
+        set_board_snapshot( &snapshots[n] );
+        fail_unless( values[n] == evaluate_position(value_list), "batch value %d", n );
+    }
+    fail_unless( values[1] == 2 + 2 * 2, "captures and edge stones" );
+
+    init_brains();
+    free_board();
+}
+END_TEST
+
+START_TEST (test_eval_terms_1)
+{
+    int k;
+    int value_list[COUNT_BRAINS];
+
+    init_board(9);
+    init_brains();
+    set_factor( 3, 1 );     // Edge stones
+
+    // Black corner stone is captured and put back:
+    set_vertex( BLACK, 0, 0 );
+    set_vertex( BLACK, 0, 4 );
+    set_vertex( WHITE, 1, 0 );
+    set_vertex( WHITE, 8, 4 );
+    fail_unless( get_stone_term(3) == -2 - 1 + 1 + 1, "edge term after moves" );
+
+    set_vertex( WHITE, 0, 1 );
+    scan_board_1();
+    fail_unless( remove_stones(BLACK) == 1, "corner stone captured" );
+    fail_unless( get_stone_term(3) == -1 + 1 + 1 + 1, "edge term after capture" );
+    fail_unless( get_stone_count(BLACK) == 1 && get_stone_count(WHITE) == 3, "stone count after capture" );
+    fail_unless( evaluate_position(value_list) == 2 - 1, "captures and edge stones" );
+
+    restore_stones(BLACK);
+    fail_unless( get_stone_term(3) == -2 - 1 + 1 + 1 + 1, "edge term after undo" );
+    fail_unless( get_stone_count(BLACK) == 2 && get_stone_count(EMPTY) == 76, "stone count after undo" );
+
+    // The kept counts are the same as after a new scan:
+    k = get_stone_count(EMPTY);
+    scan_board_2();
+    fail_unless( get_stone_count(EMPTY) == k, "empty count equals scan" );
+
+    init_brains();
+    free_board();
+}
+END_TEST
+
+START_TEST (test_worm_stats_1)
+{
+    int value_list[COUNT_BRAINS];
+    worm_stats_t stats;
+
+    init_board(9);
+    init_brains();
+    set_factor( 1, 1 );     // Atari
+    set_factor( 2, 1 );     // Average liberties
+    set_factor( 4, 1 );     // Star points
+
+    // Black stone on A1 in atari, black and white stone on star points:
+    set_vertex( BLACK, 0, 0 );
+    set_vertex( WHITE, 1, 0 );
+    set_vertex( BLACK, 2, 2 );
+    set_vertex( WHITE, 4, 4 );
+    scan_board_1();
+
+    get_worm_stats( BLACK, &stats );
+    fail_unless( stats.worms == 2 && stats.liberties == 1 + 4, "black worms and liberties" );
+    fail_unless( stats.atari_worms == 1 && stats.atari_stones == 1, "black stone in atari" );
+    get_worm_stats( WHITE, &stats );
+    fail_unless( stats.worms == 2 && stats.liberties == 2 + 4 && stats.atari_stones == 0, "white worms" );
+    fail_unless( get_worm_count_atari(BLACK) == 1 && get_worm_count_atari(WHITE) == 0, "worms in atari" );
+
+    fail_unless( get_stone_term(4) == 0, "star point term" );
+    set_vertex( WHITE, 6, 6 );
+    scan_board_1();
+    fail_unless( get_stone_term(4) == -1, "star point term after move" );
+
+    // Atari: 0 - 1, liberties: 5 / 2 - 10 / 3, star points: 1 - 2
+    fail_unless( evaluate_position(value_list) == -1 - 1 - 1, "atari, liberties and star points" );
+    fail_unless( value_list[1] == -1 && value_list[2] == -1 && value_list[4] == -1, "value per brain" );
+
+    // A star point set later counts for the black stone on A1:
+    set_hoshi( 0, 0 );
+    fail_unless( get_stone_term(4) == 0, "star point term after set_hoshi" );
+
+    init_brains();
+    free_board();
+}
+END_TEST
+
+START_TEST (test_pass_alive_1)
+{
+    int j;
+    int valid_moves[5 * 5 + 1][4];
+
+    init_board(5);
+    init_move_history();
+
+    // Black wall on column B with eyes on A2 and A4/A5, a dead white stone
+    // on A4:
+    for ( j = 0; j < 5; j++ ) {
+        set_vertex( BLACK, 1, j );
+    }
+    set_vertex( BLACK, 0, 0 );
+    set_vertex( BLACK, 0, 2 );
+    set_vertex( WHITE, 0, 3 );
+    scan_board_1();
+
+    fail_unless( get_pass_alive( 1, 2 ) == BLACK && get_pass_alive( 0, 0 ) == BLACK, "black worm is pass-alive" );
+    fail_unless( get_pass_alive( 0, 1 ) == BLACK && get_pass_alive( 0, 4 ) == BLACK, "eyes are black territory" );
+    fail_unless( get_pass_alive( 0, 3 ) == BLACK, "white stone is dead" );
+    fail_unless( get_pass_alive( 3, 3 ) == EMPTY, "open area is not pass-alive" );
+
+    // Area without Benson would be 7 + 1 + 15 - 1:
+    fail_unless( get_area_estimate() == 25, "exact area of pass-alive region" );
+    fail_unless( get_pseudo_valid_move_list( WHITE, valid_moves, true ) == 15, "no moves in black eyes" );
+    fail_unless( get_pseudo_valid_move_list( WHITE, valid_moves, false ) == 17, "eyes only skipped at root" );
+
+    // One eye is not enough:
+    set_vertex( BLACK, 0, 1 );
+    scan_board_1();
+    fail_unless( get_pass_alive( 1, 2 ) == EMPTY && get_pass_alive( 0, 4 ) == EMPTY, "one eye" );
+
+    free_move_history();
+    free_board();
+}
+END_TEST
+
+START_TEST (test_eye_shapes_1)
+{
+    int k;
+    int canonical[EYE_SIZE_MAX][2];
+    const int straight_three[3][2] = { { 5, 2 }, { 5, 3 }, { 5, 4 } };
+    const int square_four[4][2]    = { { 3, 3 }, { 4, 3 }, { 3, 4 }, { 4, 4 } };
+    const int bent_four[4][2]      = { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 2, 1 } };
+    const int bulky_five[5][2]     = { { 3, 2 }, { 2, 2 }, { 4, 2 }, { 2, 3 }, { 3, 3 } };
+    const int rabbity_six[6][2]    = { { 2, 2 }, { 1, 1 }, { 2, 1 }, { 1, 2 }, { 3, 2 }, { 2, 3 } };
+    const eye_shape_t *shape;
+
+    shape = get_eye_shape( get_eye_key( 3, straight_three, canonical ) );
+    fail_unless( shape != NULL && shape->status == EYE_UNSETTLED, "straight three is unsettled" );
+    fail_unless( shape->attack_vital == canonical[1][1] * 8 + canonical[1][0], "vital point in the middle" );
+    fail_unless( shape->defend_vital == shape->attack_vital, "same vital point for both colors" );
+
+    shape = get_eye_shape( get_eye_key( 4, square_four, NULL ) );
+    fail_unless( shape != NULL && shape->status == EYE_DEAD, "square four is dead" );
+    shape = get_eye_shape( get_eye_key( 4, bent_four, NULL ) );
+    fail_unless( shape != NULL && shape->status == EYE_ALIVE, "bent four is alive" );
+
+    // The vital point of bulky five and rabbity six is the first point:
+    shape = get_eye_shape( get_eye_key( 5, bulky_five, canonical ) );
+    fail_unless( shape != NULL && shape->status == EYE_UNSETTLED, "bulky five is unsettled" );
+    fail_unless( shape->attack_vital == canonical[0][1] * 8 + canonical[0][0], "bulky five is killed on its vital point" );
+    fail_unless( shape->defend_vital == shape->attack_vital, "bulky five lives on its vital point" );
+    shape = get_eye_shape( get_eye_key( 6, rabbity_six, canonical ) );
+    fail_unless( shape != NULL && shape->status == EYE_UNSETTLED, "rabbity six is unsettled" );
+    fail_unless( shape->attack_vital == canonical[0][1] * 8 + canonical[0][0], "rabbity six is killed in the centre" );
+    fail_unless( shape->defend_vital == shape->attack_vital, "rabbity six lives in the centre" );
+
+    // Black encloses a straight three on C4-E4:
+    init_board(7);
+    for ( k = 2; k <= 4; k++ ) {
+        set_vertex( BLACK, k, 2 );
+        set_vertex( BLACK, k, 4 );
+    }
+    set_vertex( BLACK, 1, 3 );
+    set_vertex( BLACK, 5, 3 );
+    scan_board_1();
+
+    fail_unless( is_eye_vital_point( WHITE, 3, 3 ), "white kills on D4" );
+    fail_unless( is_eye_vital_point( BLACK, 3, 3 ), "black lives on D4" );
+    fail_unless( ! is_eye_vital_point( WHITE, 2, 3 ) && ! is_eye_vital_point( BLACK, 4, 3 ), "no other vital point" );
+    fail_unless( ! is_eye_vital_point( WHITE, 0, 0 ), "big regions are not looked up" );
+
+    // Regions next to stones of both colors are not looked up:
+    set_vertex( WHITE, 2, 3 );
+    scan_board_1();
+    fail_unless( ! is_eye_vital_point( WHITE, 3, 3 ), "no vital point" );
+
+    free_board();
+}
+END_TEST
+
+START_TEST (test_network_1)
+{
+    int k;
+    int32_t header[2] = { 5, NETWORK_HIDDEN };
+    int16_t weights[ 2 * 5 * 5 + 1 ][NETWORK_HIDDEN] = { { 0 } };
+    int8_t  output[NETWORK_HIDDEN] = { 0 };
+    int32_t bias = 0;
+    int value_list[COUNT_BRAINS];
+    FILE *file;
+
+    // Row 0 is the bias, a black stone on C3 and A1 feeds neuron 0, a white
+    // stone on C3 neuron 1:
+    weights[ 1 + 2 * 5 + 2 ][0]         = 100;
+    weights[ 1 + 0 ][0]                 = 50;
+    weights[ 1 + 25 + 2 * 5 + 2 ][1]    = 100;
+    output[0] = 1 << NETWORK_SHIFT;
+    output[1] = -( 1 << NETWORK_SHIFT );
+
+    file = fopen( "check_board.net", "wb" );
+    fwrite( "HGNN", 1, 4, file );
+    fwrite( header, sizeof(int32_t), 2, file );
+    for ( k = 0; k < 2 * 5 * 5 + 1; k++ ) {
+        fwrite( weights[k], sizeof(int16_t), NETWORK_HIDDEN, file );
+    }
+    fwrite( output, sizeof(int8_t), NETWORK_HIDDEN, file );
+    fwrite( &bias, sizeof(int32_t), 1, file );
+    fclose(file);
+
+    init_board(5);
+    init_brains();
+
+    fail_unless( ! load_network("no_such_file.net") && ! is_network_loaded(), "missing file" );
+
+    set_vertex( BLACK, 2, 2 );
+    fail_unless( load_network("check_board.net"), "network loaded" );
+    remove("check_board.net");
+    fail_unless( get_network_value() == 100, "accumulator of position after load" );
+
+    // The first layer follows every change of the board:
+    set_vertex( BLACK, 0, 0 );
+    fail_unless( get_network_value() == NETWORK_CLIP, "output is clipped" );
+    set_vertex( WHITE, 2, 2 );
+    fail_unless( get_network_value() == 50 - 100, "white stone" );
+    set_vertex( EMPTY, 0, 0 );
+    set_vertex( EMPTY, 2, 2 );
+    fail_unless( get_network_value() == 0, "empty board" );
+
+    set_vertex( BLACK, 2, 2 );
+    set_factor( 7, 2 );     // Network
+    fail_unless( evaluate_position(value_list) == 200 && value_list[7] == 200, "network brain" );
+
+    // Other board sizes are not evaluated:
+    init_board(9);
+    set_vertex( BLACK, 2, 2 );
+    fail_unless( get_network_value() == 0, "network for 5x5 only" );
+
+    unload_network();
+    init_brains();
+    free_board();
+}
+END_TEST
+
+START_TEST (test_bouzy_1)
+{
+    int j;
+    int value_list[COUNT_BRAINS];
+
+    init_board(9);
+    init_brains();
+
+    compute_influence();
+    fail_unless( get_influence_territory() == 0 && get_influence( 4, 4 ) == 0, "empty board is neutral" );
+
+    set_vertex( BLACK, 4, 4 );
+    compute_influence();
+    fail_unless( get_influence( 4, 4 ) > 0 && get_influence_territory() > 0, "black stone has influence" );
+
+    // A black and a white wall, the middle column stays neutral:
+    for ( j = 0; j < 9; j++ ) {
+        set_vertex( EMPTY, 4, 4 );
+        set_vertex( BLACK, 2, j );
+        set_vertex( WHITE, 6, j );
+    }
+    compute_influence();
+    fail_unless( get_influence( 0, 4 ) > 0 && get_influence( 1, 4 ) > 0, "black side" );
+    fail_unless( get_influence( 8, 4 ) < 0 && get_influence( 7, 4 ) < 0, "white side" );
+    fail_unless( get_influence( 4, 4 ) == 0, "middle is neutral" );
+    fail_unless( get_influence_territory() == 0, "territory is equal" );
+
+    set_vertex( EMPTY, 6, 0 );
+    set_factor( 5, 1 );     // Bouzy
+    fail_unless( evaluate_position(value_list) > 0, "black has more territory" );
+    fail_unless( value_list[5] == get_influence_territory(), "brain uses influence" );
+
+    init_brains();
+    free_board();
+}
+END_TEST
+
+START_TEST (test_area_estimate_1)
+{
+    int j;
+
+    init_board(9);
+    scan_board_1();
+    fail_unless( get_area_estimate() == 0, "empty board" );
+
+    set_vertex( BLACK, 4, 4 );
+    scan_board_1();
+    fail_unless( get_area_estimate() == 81, "one black stone owns the board" );
+
+    // Black owns columns A-D, white F-J, column E is neutral:
+    set_vertex( EMPTY, 4, 4 );
+    for ( j = 0; j < 9; j++ ) {
+        set_vertex( BLACK, 2, j );
+        set_vertex( WHITE, 6, j );
+    }
+    scan_board_1();
+    fail_unless( get_area_estimate() == 0, "equal area" );
+
+    // The stone, E4 and E6 are black now, F5 is neutral:
+    set_vertex( BLACK, 4, 4 );
+    scan_board_1();
+    fail_unless( get_area_estimate() == 4, "black stone in the middle" );
+
+    // Black B5 is nearer to E5 than white J5. Vertices more than four steps
+    // away from both stones, like A1, are neutral:
+    free_board();
+    init_board(9);
+    set_vertex( BLACK, 1, 4 );
+    set_vertex( WHITE, 8, 4 );
+    scan_board_1();
+    fail_unless( get_area_estimate() == 7, "nearer color gets the area (%d)", get_area_estimate() );
+
+    free_board();
+}
+END_TEST
 
 Suite * board_suite(void) {
     Suite *s                      = suite_create("Board");
@@ -630,6 +1120,7 @@ Suite * board_suite(void) {
     TCase *tc_liberties           = tcase_create("liberties");
     TCase *tc_remove_stones       = tcase_create("remove");
     TCase *tc_atari_groups        = tcase_create("atari");
+    TCase *tc_position            = tcase_create("position");
 
     tcase_add_loop_test( tc_init_board, test_init_board_1, 0, board_count );
     tcase_add_loop_test( tc_get_board_as_string, test_get_board_as_string_1, 0, board_count );
@@ -640,6 +1131,18 @@ Suite * board_suite(void) {
     tcase_add_test( tc_liberties,     test_count_liberties_1 );
     tcase_add_test( tc_remove_stones, test_remove_stones_1   );
     tcase_add_test( tc_atari_groups,  test_atari_1           );
+    tcase_add_test( tc_atari_groups,  test_worm_liberties_1  );
+    tcase_add_test( tc_position,      test_hash_id_1         );
+    tcase_add_test( tc_position,      test_snapshot_1        );
+    tcase_add_test( tc_position,      test_pattern_1         );
+    tcase_add_test( tc_position,      test_evaluate_batch_1  );
+    tcase_add_test( tc_position,      test_eval_terms_1      );
+    tcase_add_test( tc_position,      test_worm_stats_1      );
+    tcase_add_test( tc_position,      test_bouzy_1           );
+    tcase_add_test( tc_position,      test_area_estimate_1   );
+    tcase_add_test( tc_position,      test_pass_alive_1      );
+    tcase_add_test( tc_position,      test_eye_shapes_1      );
+    tcase_add_test( tc_position,      test_network_1         );
 
     suite_add_tcase( s, tc_init_board          );
     suite_add_tcase( s, tc_get_board_as_string );
@@ -649,6 +1152,7 @@ Suite * board_suite(void) {
     suite_add_tcase( s, tc_liberties           );
     suite_add_tcase( s, tc_remove_stones       );
     suite_add_tcase( s, tc_atari_groups        );
+    suite_add_tcase( s, tc_position            );
 
     return s;
 }
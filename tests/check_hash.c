@@ -0,0 +1,109 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <check.h>
+#include "../src/global_const.h"
+#include "../src/hash.h"
+
+START_TEST (test_probe_empty)
+{
+    hash_entry_t entry;
+
+    init_hash_table();
+
+    fail_unless( probe_hash_table( 0, &entry ) == false, "empty table: hash id 0 not found" );
+    fail_unless( probe_hash_table( 12345, &entry ) == false, "empty table: hash id not found" );
+
+    free_hash_table();
+}
+END_TEST
+
+START_TEST (test_store_probe)
+{
+    hash_entry_t entry;
+    hash_t hash_id = 0x0123456789ABCDEFULL;
+
+    init_hash_table();
+
+    store_hash_table( hash_id, 3, HASH_LOWER, -42, 4, 17 );
+
+    fail_unless( probe_hash_table( hash_id, &entry ) == true, "stored entry found" );
+    fail_unless( entry.value == -42,        "value is -42"     );
+    fail_unless( entry.depth == 3,          "depth is 3"       );
+    fail_unless( entry.flag  == HASH_LOWER, "flag is lower"    );
+    fail_unless( entry.i     == 4,          "i is 4"           );
+    fail_unless( entry.j     == 17,         "j is 17"          );
+
+    // Same slot, different hash id:
+    fail_unless( probe_hash_table( hash_id ^ ( 1ULL << 60 ), &entry ) == false, "other hash id not found" );
+
+    store_hash_table( hash_id, 0, HASH_EXACT, 0, INVALID, INVALID );
+    fail_unless( probe_hash_table( hash_id, &entry ) == true, "replaced entry found" );
+    fail_unless( entry.value == 0,          "value is 0"       );
+    fail_unless( entry.flag  == HASH_EXACT, "flag is exact"    );
+    fail_unless( entry.i     == INVALID,    "no move stored"   );
+
+    clear_hash_table();
+    fail_unless( probe_hash_table( hash_id, &entry ) == false, "entry deleted" );
+
+    free_hash_table();
+}
+END_TEST
+
+START_TEST (test_hash_size)
+{
+    hash_entry_t entry;
+    hash_t hash_id = 0x0123456789ABCDEFULL;
+
+    fail_unless( get_hash_table_size() == HASH_TABLE_SIZE, "default size" );
+    fail_unless( ! set_hash_table_size( HASH_TABLE_BITS_MIN - 1 ), "too small" );
+    fail_unless( ! set_hash_table_size( HASH_TABLE_BITS_MAX + 1 ), "too big" );
+
+    init_hash_table();
+    store_hash_table( hash_id, 1, HASH_EXACT, 7, 1, 2 );
+
+    // The table is allocated again:
+    fail_unless( set_hash_table_size(HASH_TABLE_BITS_MIN), "minimum size" );
+    fail_unless( get_hash_table_size() == 1 << HASH_TABLE_BITS_MIN, "size is set" );
+    fail_unless( probe_hash_table( hash_id, &entry ) == false, "entries are lost" );
+
+    store_hash_table( hash_id, 1, HASH_EXACT, 7, 1, 2 );
+    fail_unless( probe_hash_table( hash_id, &entry ) && entry.value == 7, "small table works" );
+
+    free_hash_table();
+    set_hash_table_size(20);
+}
+END_TEST
+
+START_TEST (test_hash_color)
+{
+    fail_unless( get_hash_color(BLACK) != get_hash_color(WHITE), "side to move changes hash id" );
+    fail_unless( get_hash_color(WHITE) == 0, "white to move does not change hash id" );
+}
+END_TEST
+
+Suite * hash_suite(void) {
+    Suite *s = suite_create("Hash");
+
+    TCase *tc_core = tcase_create("Core");
+
+    tcase_add_test( tc_core, test_probe_empty );
+    tcase_add_test( tc_core, test_store_probe );
+    tcase_add_test( tc_core, test_hash_color  );
+    tcase_add_test( tc_core, test_hash_size   );
+
+    suite_add_tcase( s, tc_core );
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+
+    Suite *s = hash_suite();
+    SRunner *sr = srunner_create(s);
+    srunner_run_all( sr, CK_NORMAL );
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return ( number_failed == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
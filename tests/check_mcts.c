@@ -0,0 +1,324 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include <check.h>
+#include "../src/global_const.h"
+#include "../src/board.h"
+#include "../src/move.h"
+#include "../src/search.h"
+#include "../src/mcts.h"
+
+START_TEST (test_playouts)
+{
+    fail_unless( get_playouts() == DEFAULT_PLAYOUTS, "playouts is default" );
+
+    set_playouts(50);
+    fail_unless( get_playouts() == 50, "playouts is 50" );
+
+    set_playouts(DEFAULT_PLAYOUTS);
+}
+END_TEST
+
+START_TEST (test_mcts_valid)
+{
+    int i, j;
+    search_stats_t search_stats;
+
+    init_board(5);
+    init_move_history();
+
+    set_vertex( BLACK, 1, 1 );
+    set_vertex( WHITE, 2, 1 );
+
+    set_playouts(200);
+    mcts_search( WHITE, 0.5, &i, &j );
+    search_stats = get_search_stats();
+
+    fail_unless( i != INVALID && j != INVALID, "valid move returned" );
+    fail_unless( get_vertex( i, j ) == EMPTY, "move on empty vertex" );
+    fail_unless( get_vertex( 1, 1 ) == BLACK && get_vertex( 2, 1 ) == WHITE, "board unchanged" );
+    scan_board_2();
+    fail_unless( get_stone_count(BLACK) == 1 && get_stone_count(WHITE) == 1, "no stones left over" );
+    fail_unless( search_stats.playouts == 200, "all playouts done" );
+    fail_unless( search_stats.node_count > 0, "nodes counted" );
+    fail_unless( search_stats.value >= 0 && search_stats.value <= 100, "value is win rate" );
+
+    set_playouts(DEFAULT_PLAYOUTS);
+}
+END_TEST
+
+START_TEST (test_mcts_capture)
+{
+    int i, j;
+    int k;
+
+    // Both middle groups have only the liberty A5 left. Black wins by
+    // capturing first, with komi 10.5 black loses after being captured:
+    init_board(5);
+    init_move_history();
+
+    for ( k = 0; k < 5; k++ ) {
+        set_vertex( WHITE, 1, k );
+        set_vertex( BLACK, 2, k );
+        if ( k < 4 ) {
+            set_vertex( BLACK, 0, k );
+        }
+    }
+
+    set_playouts(1000);
+    mcts_search( BLACK, 10.5, &i, &j );
+
+    fail_unless( i == 0 && j == 4, "capturing move returned" );
+
+    set_playouts(DEFAULT_PLAYOUTS);
+}
+END_TEST
+
+START_TEST (test_mcts_rave)
+{
+    int i, j;
+    int k;
+
+    fail_unless( get_rave() == true, "RAVE is on by default" );
+    set_rave(false);
+    fail_unless( get_rave() == false, "RAVE is off" );
+    set_rave(true);
+
+    // Same position as in test_mcts_capture, but far fewer playouts:
+    init_board(5);
+    init_move_history();
+
+    for ( k = 0; k < 5; k++ ) {
+        set_vertex( WHITE, 1, k );
+        set_vertex( BLACK, 2, k );
+        if ( k < 4 ) {
+            set_vertex( BLACK, 0, k );
+        }
+    }
+
+    set_playouts(100);
+    mcts_search( BLACK, 10.5, &i, &j );
+
+    fail_unless( i == 0 && j == 4, "capturing move returned" );
+
+    set_playouts(DEFAULT_PLAYOUTS);
+}
+END_TEST
+
+START_TEST (test_mcts_threads)
+{
+    int i, j;
+    int k;
+    search_stats_t search_stats;
+
+    init_board(5);
+    init_move_history();
+
+    for ( k = 0; k < 5; k++ ) {
+        set_vertex( WHITE, 1, k );
+        set_vertex( BLACK, 2, k );
+        if ( k < 4 ) {
+            set_vertex( BLACK, 0, k );
+        }
+    }
+
+    set_thread_count(4);
+    set_playouts(2000);
+    mcts_search( BLACK, 10.5, &i, &j );
+    search_stats = get_search_stats();
+
+    fail_unless( search_stats.threads == 4, "four threads used" );
+    fail_unless( search_stats.playouts == 2000, "all playouts done" );
+    fail_unless( i == 0 && j == 4, "capturing move returned" );
+    fail_unless( get_vertex( 0, 4 ) == EMPTY && get_vertex( 1, 0 ) == WHITE, "board unchanged" );
+
+    set_thread_count(DEFAULT_THREADS);
+    set_playouts(DEFAULT_PLAYOUTS);
+}
+END_TEST
+
+START_TEST (test_mcts_reuse)
+{
+    int i, j;
+    search_stats_t search_stats;
+
+    init_board(5);
+    init_move_history();
+
+    set_playouts(500);
+    mcts_search( BLACK, 0.5, &i, &j );
+    search_stats = get_search_stats();
+    fail_unless( search_stats.reused_visits == 0, "nothing reused in first search" );
+
+    // Follow the selected move and the answer of white, which has been
+    // searched in the same tree:
+    set_vertex( BLACK, i, j );
+    mcts_play_move( BLACK, i, j );
+    mcts_search( WHITE, 0.5, &i, &j );
+    set_vertex( WHITE, i, j );
+    mcts_play_move( WHITE, i, j );
+
+    mcts_search( BLACK, 0.5, &i, &j );
+    search_stats = get_search_stats();
+    fail_unless( search_stats.reused_visits > 0, "subtree reused" );
+    fail_unless( get_vertex( i, j ) == EMPTY, "move on empty vertex" );
+
+    // A different komi is a different search:
+    mcts_search( BLACK, 10.5, &i, &j );
+    search_stats = get_search_stats();
+    fail_unless( search_stats.reused_visits == 0, "tree dropped for other komi" );
+
+    free_search_tree();
+    set_playouts(DEFAULT_PLAYOUTS);
+}
+END_TEST
+
+START_TEST (test_mcts_ponder)
+{
+    int i, j;
+    search_stats_t search_stats;
+    struct timespec wait = { 0, 100000000 };
+
+    init_board(5);
+    init_move_history();
+    set_vertex( BLACK, 2, 2 );
+
+    start_pondering( WHITE, 0.5 );
+    fail_unless( is_pondering() == true, "pondering started" );
+    nanosleep( &wait, NULL );
+    stop_pondering();
+    fail_unless( is_pondering() == false, "pondering stopped" );
+    fail_unless( get_vertex( 2, 2 ) == BLACK, "board unchanged" );
+
+    set_playouts(100);
+    mcts_search( WHITE, 0.5, &i, &j );
+    search_stats = get_search_stats();
+    fail_unless( search_stats.reused_visits > 0, "ponder playouts kept" );
+    fail_unless( search_stats.playouts == 100, "only playouts of this search counted (%d)", search_stats.playouts );
+    fail_unless( get_vertex( i, j ) == EMPTY, "move on empty vertex" );
+
+    free_search_tree();
+    set_playouts(DEFAULT_PLAYOUTS);
+}
+END_TEST
+
+START_TEST (test_mcts_memory)
+{
+    int i, j;
+    unsigned int tree_nodes;
+    search_stats_t search_stats;
+
+    fail_unless( get_tree_memory() == DEFAULT_TREE_MEMORY, "memory limit is default" );
+
+    init_board(7);
+    init_move_history();
+
+    // A pool of 1 MB is full long before the search ends:
+    set_tree_memory(1);
+    set_playouts(20000);
+    mcts_search( BLACK, 0.5, &i, &j );
+    search_stats = get_search_stats();
+    tree_nodes   = get_tree_nodes();
+
+    fail_unless( search_stats.playouts == 20000, "all playouts done" );
+    fail_unless( tree_nodes == search_stats.tree_nodes, "tree nodes in stats" );
+    fail_unless( tree_nodes <= 1024 * 1024 / 28, "pool limit kept" );
+    fail_unless( tree_nodes > 1024 * 1024 / 28 - 50, "pool is full" );
+    fail_unless( get_vertex( i, j ) == EMPTY, "move on empty vertex" );
+
+    // Only the subtree of the played move is left:
+    set_vertex( BLACK, i, j );
+    mcts_play_move( BLACK, i, j );
+    fail_unless( get_tree_nodes() > 0 && get_tree_nodes() < tree_nodes, "tree collected" );
+
+    set_tree_memory(DEFAULT_TREE_MEMORY);
+    fail_unless( get_tree_nodes() == 0, "tree dropped with new limit" );
+    set_playouts(DEFAULT_PLAYOUTS);
+}
+END_TEST
+
+START_TEST (test_mcts_widening)
+{
+    int i, j;
+    int k;
+    search_stats_t search_stats;
+
+    // White string of nine stones in atari. The capture has the best prior,
+    // so the first playout goes to it and not to one of the 361 moves:
+    init_board(19);
+    init_move_history();
+
+    set_vertex( BLACK, 4, 2 );
+    for ( k = 3; k < 12; k++ ) {
+        set_vertex( WHITE, 4, k );
+        set_vertex( BLACK, 3, k );
+        set_vertex( BLACK, 5, k );
+    }
+
+    set_playouts(1);
+    mcts_search( BLACK, 0.5, &i, &j );
+    search_stats = get_search_stats();
+
+    fail_unless( i == 4 && j == 12, "capture tried first" );
+    fail_unless( search_stats.tree_nodes > 0, "tree built" );
+
+    free_search_tree();
+    set_playouts(DEFAULT_PLAYOUTS);
+}
+END_TEST
+
+START_TEST (test_mcts_pass)
+{
+    int i, j;
+    int k, l;
+
+    // Black owns the whole board except two eyes:
+    init_board(5);
+    init_move_history();
+
+    for ( k = 0; k < 5; k++ ) {
+        for ( l = 0; l < 5; l++ ) {
+            set_vertex( BLACK, k, l );
+        }
+    }
+    set_vertex( EMPTY, 0, 0 );
+    set_vertex( EMPTY, 2, 2 );
+
+    mcts_search( BLACK, 0.5, &i, &j );
+
+    fail_unless( i == INVALID && j == INVALID, "pass instead of filling own eye" );
+}
+END_TEST
+
+Suite * mcts_suite(void) {
+    Suite *s = suite_create("MCTS");
+
+    TCase *tc_mcts = tcase_create("mcts");
+
+    tcase_add_test( tc_mcts, test_playouts     );
+    tcase_add_test( tc_mcts, test_mcts_valid   );
+    tcase_add_test( tc_mcts, test_mcts_capture );
+    tcase_add_test( tc_mcts, test_mcts_rave    );
+    tcase_add_test( tc_mcts, test_mcts_threads );
+    tcase_add_test( tc_mcts, test_mcts_reuse   );
+    tcase_add_test( tc_mcts, test_mcts_ponder  );
+    tcase_add_test( tc_mcts, test_mcts_memory  );
+    tcase_add_test( tc_mcts, test_mcts_widening );
+    tcase_add_test( tc_mcts, test_mcts_pass    );
+
+    suite_add_tcase( s, tc_mcts );
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+
+    Suite *s = mcts_suite();
+    SRunner *sr = srunner_create(s);
+    srunner_run_all( sr, CK_NORMAL );
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return ( number_failed == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
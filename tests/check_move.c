@@ -5,6 +5,7 @@
 #include "../src/global_const.h"
 #include "../src/move.h"
 #include "../src/board.h"
+#include "../src/evaluate.h"
 
 extern int move_number;
 
@@ -386,7 +387,7 @@ START_TEST (test_get_pseudo_valid_move_list)
 
         init_board(board_size);
 
-        nr_of_valid_moves = get_pseudo_valid_move_list( color, valid_moves );
+        nr_of_valid_moves = get_pseudo_valid_move_list( color, valid_moves, true );
 
         fail_if( nr_of_valid_moves != board_size * board_size
             , "valid moves %d (%d)", board_size * board_size, nr_of_valid_moves );
@@ -406,7 +407,7 @@ START_TEST (test_get_pseudo_valid_move_list)
         init_move_history();
 
         set_vertex( color, 0, 0 );
-        nr_of_valid_moves = get_pseudo_valid_move_list( color * -1, valid_moves );
+        nr_of_valid_moves = get_pseudo_valid_move_list( color * -1, valid_moves, true );
 
         fail_if( nr_of_valid_moves != board_size * board_size - 1
             , "valid moves %d (%d)", board_size * board_size - 1, nr_of_valid_moves );
@@ -434,7 +435,7 @@ START_TEST (test_get_pseudo_valid_move_list)
             }
         }
 
-        nr_of_valid_moves = get_pseudo_valid_move_list( color * -1, valid_moves );
+        nr_of_valid_moves = get_pseudo_valid_move_list( color * -1, valid_moves, true );
 
         fail_if( nr_of_valid_moves != 2
             , "valid moves %d (%d)", 2, nr_of_valid_moves );
@@ -462,7 +463,7 @@ START_TEST (test_get_pseudo_valid_move_list)
             }
         }
 
-        nr_of_valid_moves = get_pseudo_valid_move_list( color * -1, valid_moves );
+        nr_of_valid_moves = get_pseudo_valid_move_list( color * -1, valid_moves, true );
 
         fail_if( nr_of_valid_moves != 1
             , "valid moves %d (%d)", 1, nr_of_valid_moves );
@@ -491,10 +492,10 @@ START_TEST (test_get_valid_move_list)
     set_vertex( BLACK, 1, 0 );
     set_vertex( BLACK, 1, 1 );
 
-    nr_of_valid_moves = get_valid_move_list( BLACK, valid_moves );
+    nr_of_valid_moves = get_valid_move_list( BLACK, valid_moves, true );
     fail_unless( nr_of_valid_moves == 0, "no valid moves (%d)", nr_of_valid_moves );
 
-    nr_of_valid_moves = get_valid_move_list( WHITE, valid_moves );
+    nr_of_valid_moves = get_valid_move_list( WHITE, valid_moves, true );
     fail_unless( nr_of_valid_moves == 0, "no valid moves (%d)", nr_of_valid_moves );
 
     set_vertex( EMPTY, 0, 0 );
@@ -505,7 +506,7 @@ START_TEST (test_get_valid_move_list)
 
     // Check for black moves:
     color = BLACK;
-    nr_of_valid_moves = get_valid_move_list( color, valid_moves );
+    nr_of_valid_moves = get_valid_move_list( color, valid_moves, true );
 
     fail_unless( nr_of_valid_moves == 4, "4 valid moves (%d)", nr_of_valid_moves );
 
@@ -527,7 +528,7 @@ START_TEST (test_get_valid_move_list)
 
     // Check for white moves:
     color = WHITE;
-    nr_of_valid_moves = get_valid_move_list( color, valid_moves );
+    nr_of_valid_moves = get_valid_move_list( color, valid_moves, true );
 
     fail_unless( nr_of_valid_moves == 4, "4 valid moves (%d)", nr_of_valid_moves );
 
@@ -550,6 +551,130 @@ START_TEST (test_get_valid_move_list)
 }
 END_TEST
 
+START_TEST (test_get_valid_move_list_batch)
+{
+    int valid_moves[BOARD_SIZE_MAX * BOARD_SIZE_MAX][4];
+    int value_list[COUNT_BRAINS];
+    int nr_of_valid_moves;
+    int pass;
+    int k;
+    int i, j;
+    int value;
+
+    init_board(5);
+    init_brains();
+
+    // The capture on A2 also saves the black stone on B1 from atari:
+    set_vertex( WHITE, 0, 0 );
+    set_vertex( BLACK, 1, 0 );
+    set_vertex( WHITE, 2, 0 );
+    set_vertex( WHITE, 3, 3 );
+
+    // The terms of the default brains are kept by the board, the atari and
+    // Bouzy brains have no batch function, so neither is batched:
+    for ( pass = 0; pass < 2; pass++ ) {
+        if ( pass == 0 ) {
+            fail_unless( ! is_batch_evaluation(), "no batch for board terms" );
+        }
+        else {
+            set_factor( 1, 1 );
+            set_factor( 5, 1 );
+            fail_unless( ! is_batch_evaluation(), "no batch evaluation" );
+        }
+
+        nr_of_valid_moves = get_valid_move_list( BLACK, valid_moves, true );
+        fail_unless( nr_of_valid_moves == 21, "21 valid moves (%d)", nr_of_valid_moves );
+        fail_unless( pass == 1 || ( valid_moves[0][0] == 0 && valid_moves[0][1] == 1 )
+            , "capture is first (%d,%d)", valid_moves[0][0], valid_moves[0][1] );
+
+        // Ordering values are the values of the positions after the moves,
+        // also after a capture:
+        clear_eval_cache();
+        for ( k = 0; k < nr_of_valid_moves; k++ ) {
+            i = valid_moves[k][0];
+            j = valid_moves[k][1];
+            set_vertex( BLACK, i, j );
+            scan_board_1();
+            if ( remove_stones(WHITE) > 0 ) {
+                scan_board_1();
+            }
+            value = evaluate_position(value_list);
+            set_vertex( EMPTY, i, j );
+            restore_stones(WHITE);
+            fail_unless( valid_moves[k][2] == value
+                , "value of %d,%d is %d (%d)", i, j, value, valid_moves[k][2] );
+        }
+    }
+
+    set_factor( 1, 0 );
+    set_factor( 5, 0 );
+    free_move_stack();
+    free_board();
+}
+END_TEST
+
+START_TEST (test_get_tactical_move_list)
+{
+    int tactical_moves[BOARD_SIZE_MAX * BOARD_SIZE_MAX][4];
+    int nr_of_tactical_moves;
+
+    init_board(5);
+    init_move_history();
+
+    set_vertex( BLACK, 0, 0 );
+    set_vertex( WHITE, 1, 0 );
+    set_vertex( WHITE, 2, 0 );
+    set_vertex( BLACK, 3, 0 );
+    set_vertex( BLACK, 4, 0 );
+    set_vertex( WHITE, 3, 1 );
+    scan_board_1();
+
+    // White captures two stones first, then one stone:
+    nr_of_tactical_moves = get_tactical_move_list( WHITE, tactical_moves );
+    fail_unless( nr_of_tactical_moves == 2, "2 tactical moves (%d)", nr_of_tactical_moves );
+    fail_unless( tactical_moves[0][0] == 4 && tactical_moves[0][1] == 1
+        , "first move is 4,1 (%d,%d)", tactical_moves[0][0], tactical_moves[0][1] );
+    fail_unless( tactical_moves[0][3] == 2, "captures 2 stones (%d)", tactical_moves[0][3] );
+    fail_unless( tactical_moves[1][0] == 0 && tactical_moves[1][1] == 1
+        , "second move is 0,1 (%d,%d)", tactical_moves[1][0], tactical_moves[1][1] );
+    fail_unless( tactical_moves[2][0] == INVALID, "list is terminated" );
+
+    // Black has two escapes and two ataris on the white worm 1,0-2,0:
+    nr_of_tactical_moves = get_tactical_move_list( BLACK, tactical_moves );
+    fail_unless( nr_of_tactical_moves == 4, "4 tactical moves (%d)", nr_of_tactical_moves );
+}
+END_TEST
+
+START_TEST (test_move_stack_1)
+{
+    int (*list_1)[4];
+    int (*list_2)[4];
+    int (*list_3)[4];
+    int nr_of_moves;
+
+    init_board(5);
+    init_move_history();
+
+    list_1      = open_move_list();
+    nr_of_moves = get_pseudo_valid_move_list( BLACK, list_1, false );
+    close_move_list(nr_of_moves);
+    fail_unless( nr_of_moves == 25, "25 moves (%d)", nr_of_moves );
+
+    // The next list starts behind the terminating entry of the first one:
+    list_2 = open_move_list();
+    fail_unless( list_2 == list_1 + nr_of_moves + 1, "second list follows first list" );
+    close_move_list(0);
+
+    // Freeing the first list frees all lists opened after it:
+    free_move_list(list_1);
+    list_3 = open_move_list();
+    fail_unless( list_3 == list_1, "first list is reused" );
+    free_move_list(list_3);
+
+    free_move_stack();
+}
+END_TEST
+
 START_TEST (test_last_move_1)
 {
     int k;
@@ -610,6 +735,9 @@ Suite * move_suite(void) {
     tcase_add_test( tc_push_move,                test_push_move                  );
     tcase_add_test( tc_valid_move_list,          test_get_pseudo_valid_move_list );
     tcase_add_test( tc_valid_move_list,          test_get_valid_move_list        );
+    tcase_add_test( tc_valid_move_list,          test_get_valid_move_list_batch  );
+    tcase_add_test( tc_valid_move_list,          test_get_tactical_move_list     );
+    tcase_add_test( tc_valid_move_list,          test_move_stack_1               );
     tcase_add_test( tc_last_move,                test_last_move_1                );
 
     tcase_add_exit_test( tc_push_move, test_push_move_fail, EXIT_FAILURE );
@@ -0,0 +1,239 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <check.h>
+#include "../src/global_const.h"
+#include "../src/board.h"
+#include "../src/pattern.h"
+#include "../src/playout.h"
+
+START_TEST (test_playout_init)
+{
+    playout_board_t pb;
+    int moves[BOARD_SIZE_MAX * BOARD_SIZE_MAX][2];
+
+    init_board(5);
+    set_vertex( BLACK, 0, 0 );
+    set_vertex( WHITE, 3, 3 );
+
+    init_playout_board( &pb, INVALID, INVALID );
+
+    fail_unless( pb.empty_count == 23, "23 empty vertices" );
+    fail_unless( pb.color[ get_playout_vertex( &pb, 0, 0 ) ] == BLACK, "black stone copied" );
+    fail_unless( pb.color[ get_playout_vertex( &pb, 3, 3 ) ] == WHITE, "white stone copied" );
+    fail_unless( pb.liberties[ get_playout_vertex( &pb, 0, 0 ) ] == 2, "corner stone has 2 liberties" );
+    fail_unless( get_playout_moves( &pb, BLACK, moves ) == 23, "all empty vertices playable" );
+
+    free_board();
+}
+END_TEST
+
+START_TEST (test_playout_capture)
+{
+    playout_board_t pb;
+
+    // White stone in atari, black captures at (2,1):
+    init_board(5);
+    set_vertex( WHITE, 1, 1 );
+    set_vertex( BLACK, 0, 1 );
+    set_vertex( BLACK, 1, 0 );
+    set_vertex( BLACK, 1, 2 );
+
+    init_playout_board( &pb, INVALID, INVALID );
+
+    fail_unless( play_playout_move( &pb, BLACK, 2, 1 ) == true, "capture is legal" );
+    fail_unless( pb.color[ get_playout_vertex( &pb, 1, 1 ) ] == EMPTY, "white stone captured" );
+    fail_unless( pb.empty_count == 21, "captured vertex is empty again" );
+    fail_unless( pb.ko == 0, "no ko" );
+
+    // Suicide is illegal:
+    fail_unless( play_playout_move( &pb, WHITE, 1, 1 ) == false, "suicide is illegal" );
+    fail_unless( play_playout_move( &pb, WHITE, 4, 4 ) == true, "corner is legal" );
+    fail_unless( play_playout_move( &pb, BLACK, 1, 1 ) == true, "own group is legal" );
+
+    free_board();
+}
+END_TEST
+
+START_TEST (test_playout_ko)
+{
+    playout_board_t pb;
+
+    // Ko at (1,1) and (2,1):
+    init_board(5);
+    set_vertex( BLACK, 1, 0 );
+    set_vertex( BLACK, 0, 1 );
+    set_vertex( BLACK, 1, 2 );
+    set_vertex( WHITE, 2, 0 );
+    set_vertex( WHITE, 3, 1 );
+    set_vertex( WHITE, 2, 2 );
+    set_vertex( WHITE, 1, 1 );
+
+    init_playout_board( &pb, INVALID, INVALID );
+
+    fail_unless( play_playout_move( &pb, BLACK, 2, 1 ) == true, "black takes ko" );
+    fail_unless( pb.ko == get_playout_vertex( &pb, 1, 1 ), "ko vertex set" );
+    fail_unless( play_playout_move( &pb, WHITE, 1, 1 ) == false, "white cannot retake at once" );
+    fail_unless( play_playout_move( &pb, WHITE, INVALID, INVALID ) == true, "white passes" );
+    fail_unless( pb.ko == 0, "ko vertex reset" );
+    fail_unless( play_playout_move( &pb, WHITE, 1, 1 ) == true, "white retakes later" );
+
+    free_board();
+}
+END_TEST
+
+START_TEST (test_playout_random)
+{
+    int i, j;
+    int k, l;
+    int v, n;
+    int head;
+    int count;
+    int liberties;
+    unsigned short pattern;
+    playout_board_t pb;
+    int neighbour[4];
+
+    init_board(7);
+
+    for ( k = 0; k < 20; k++ ) {
+        init_playout_board( &pb, INVALID, INVALID );
+        play_random_playout( &pb, BLACK, NULL );
+
+        neighbour[0] = 1;
+        neighbour[1] = -1;
+        neighbour[2] = pb.width;
+        neighbour[3] = -pb.width;
+
+        for ( j = 0; j < 7; j++ ) {
+            for ( i = 0; i < 7; i++ ) {
+                v = get_playout_vertex( &pb, i, j );
+
+                // Incremental pattern is up to date:
+                pattern = 0;
+                for ( l = 0; l < 8; l++ ) {
+                    n = v + pb.pattern_offset[l];
+                    pattern |= get_pattern_code( pb.color[n] ) << ( 2 * l );
+                }
+                fail_unless( pb.pattern[v] == pattern, "pattern of vertex" );
+
+                // At the end of a playout only eyes are left:
+                if ( pb.color[v] == EMPTY ) {
+                    for ( l = 0; l < 4; l++ ) {
+                        fail_unless( pb.color[ v + neighbour[l] ] != EMPTY, "no empty neighbour" );
+                    }
+                    continue;
+                }
+
+                // String data is up to date:
+                head      = pb.string[v];
+                count     = 0;
+                liberties = 0;
+                n = head;
+                do {
+                    count++;
+                    for ( l = 0; l < 4; l++ ) {
+                        if ( pb.color[ n + neighbour[l] ] == EMPTY ) {
+                            liberties++;
+                        }
+                    }
+                    n = pb.next[n];
+                } while ( n != head );
+
+                fail_unless( pb.stones[head] == count, "stone count of string" );
+                fail_unless( pb.liberties[head] == liberties, "pseudo-liberties of string" );
+                fail_unless( liberties > 0, "no string without liberties" );
+            }
+        }
+    }
+
+    free_board();
+}
+END_TEST
+
+START_TEST (test_playout_score)
+{
+    playout_board_t pb;
+
+    // Black wall on column 2 owns the left part:
+    init_board(5);
+    set_vertex( BLACK, 2, 0 );
+    set_vertex( BLACK, 2, 1 );
+    set_vertex( BLACK, 2, 2 );
+    set_vertex( BLACK, 2, 3 );
+    set_vertex( BLACK, 2, 4 );
+    set_vertex( WHITE, 3, 0 );
+    set_vertex( WHITE, 3, 1 );
+    set_vertex( WHITE, 3, 2 );
+    set_vertex( WHITE, 3, 3 );
+    set_vertex( WHITE, 3, 4 );
+    set_vertex( BLACK, 0, 0 );
+    set_vertex( BLACK, 0, 2 );
+    set_vertex( BLACK, 0, 4 );
+    set_vertex( BLACK, 1, 1 );
+    set_vertex( BLACK, 1, 3 );
+
+    init_playout_board( &pb, INVALID, INVALID );
+
+    // Black: 10 stones, 5 eyes; white: 5 stones, column 4 is not surrounded:
+    fail_unless( get_playout_score( &pb, 0.5 ) == 9.5, "black leads by 9.5" );
+
+    free_board();
+}
+END_TEST
+
+START_TEST (test_playout_score_neutral)
+{
+    int j;
+    playout_board_t pb;
+
+    // Black on columns 0 and 1, white on columns 3 and 4; C2 and C4 are
+    // next to both colors:
+    init_board(5);
+    for ( j = 0; j < 5; j++ ) {
+        set_vertex( BLACK, 0, j );
+        set_vertex( BLACK, 1, j );
+        set_vertex( WHITE, 3, j );
+        set_vertex( WHITE, 4, j );
+    }
+    set_vertex( BLACK, 2, 0 );
+    set_vertex( BLACK, 2, 2 );
+    set_vertex( BLACK, 2, 4 );
+
+    init_playout_board( &pb, INVALID, INVALID );
+
+    // Black: 13 stones, white: 10 stones, the two neutral points count for
+    // nobody:
+    fail_unless( get_playout_score( &pb, 0.5 ) == 2.5, "neutral points count for nobody" );
+
+    free_board();
+}
+END_TEST
+
+Suite * playout_suite(void) {
+    Suite *s = suite_create("Playout");
+
+    TCase *tc_playout = tcase_create("playout");
+
+    tcase_add_test( tc_playout, test_playout_init    );
+    tcase_add_test( tc_playout, test_playout_capture );
+    tcase_add_test( tc_playout, test_playout_ko      );
+    tcase_add_test( tc_playout, test_playout_random  );
+    tcase_add_test( tc_playout, test_playout_score   );
+    tcase_add_test( tc_playout, test_playout_score_neutral );
+
+    suite_add_tcase( s, tc_playout );
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+
+    Suite *s = playout_suite();
+    SRunner *sr = srunner_create(s);
+    srunner_run_all( sr, CK_NORMAL );
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return ( number_failed == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -53,6 +53,9 @@ START_TEST ( test_sort_by_value )
 
     int result;
 
+    // Moves of the same value are compared by their 3x3 patterns:
+    init_board(9);
+
     result = compare_value_black( (void *) move1, (void *) move2 );
     fail_unless( result == 0, "both moves equal" );
     result = compare_value_white( (void *) move1, (void *) move2 );
@@ -72,6 +75,15 @@ START_TEST ( test_sort_by_value )
     result = compare_value_white( (void *) move1, (void *) move2 );
     fail_unless( result == -1, "move 2 has higher value" );
 
+    // Same value, but move 1 cuts two white stones:
+    move1[2] = 0;
+    set_vertex( WHITE, 1, 0 );
+    set_vertex( WHITE, 0, 1 );
+
+    result = compare_value_black( (void *) move1, (void *) move2 );
+    fail_unless( result == -1, "move 1 has better shape" );
+
+    free_board();
 }
 END_TEST
 
@@ -165,6 +177,247 @@ START_TEST ( test_search_pass )
 }
 END_TEST
 
+START_TEST ( test_search_threads )
+{
+    int i, j;
+    int i_single, j_single;
+    search_stats_t search_stats;
+
+    fail_unless( get_thread_count() == DEFAULT_THREADS, "threads is default" );
+
+    init_board(9);
+    init_move_history();
+    init_brains();
+    init_hash_table();
+
+    set_vertex( BLACK, 2, 2 );
+    set_vertex( WHITE, 3, 2 );
+    set_vertex( WHITE, 2, 3 );
+
+    set_search_depth(1);
+    search_tree( BLACK, &i_single, &j_single );
+    search_stats = get_search_stats();
+    fail_unless( search_stats.threads == 1, "one thread used" );
+
+    clear_hash_table();
+    set_thread_count(4);
+    search_tree( BLACK, &i, &j );
+    search_stats = get_search_stats();
+
+    fail_unless( i != INVALID && j != INVALID, "valid move returned" );
+    fail_unless( get_vertex( i, j ) == EMPTY, "move on empty vertex" );
+    fail_unless( search_stats.threads == 4, "four threads used" );
+    fail_unless( search_stats.node_count > 0, "nodes counted" );
+    fail_unless( get_vertex( 2, 2 ) == BLACK && get_vertex( 3, 2 ) == WHITE, "board unchanged" );
+
+    set_thread_count(DEFAULT_THREADS);
+    free_hash_table();
+    free_board();
+}
+END_TEST
+
+START_TEST ( test_search_eval_cache )
+{
+    int i, j;
+    int value;
+    int value_list[COUNT_BRAINS];
+    int cached_list[COUNT_BRAINS];
+    unsigned long long int probes, hits;
+    search_stats_t search_stats;
+
+    init_board(5);
+    init_move_history();
+    init_brains();
+    init_hash_table();
+
+    // Second evaluation of a position is taken from the cache:
+    set_vertex( BLACK, 1, 1 );
+    set_black_captured(3);
+    reset_eval_cache_stats();
+    value = evaluate_position(value_list);
+    fail_unless( evaluate_position(cached_list) == value, "same value from cache" );
+    fail_unless( cached_list[0] == value_list[0] && value == 3, "same value list from cache" );
+    get_eval_cache_stats( &probes, &hits );
+    fail_unless( probes == 2 && hits == 1, "one hit in two probes" );
+
+    // A new factor is not hidden by the cache:
+    set_factor( 0, 2 );
+    fail_unless( evaluate_position(value_list) == 6, "cache cleared for new factor" );
+    init_brains();
+
+    // Iterative deepening evaluates positions again:
+    set_black_captured(0);
+    set_search_depth(3);
+    search_tree( WHITE, &i, &j );
+    search_stats = get_search_stats();
+
+    fail_unless( search_stats.eval_probes > 0, "cache used by search" );
+    fail_unless( search_stats.eval_hits > 0 && search_stats.eval_hits < search_stats.eval_probes, "some hits" );
+
+    set_search_depth(DEFAULT_SEARCH_DEPTH);
+    free_hash_table();
+    free_board();
+}
+END_TEST
+
+START_TEST ( test_search_eval_window )
+{
+    int value;
+    int value_list[COUNT_BRAINS];
+    unsigned long long int lazy;
+    unsigned long long int skips[EVAL_TIERS];
+
+    init_board(5);
+    init_move_history();
+    init_brains();
+    set_factor( 5, 1 );     // Bouzy, at most 25 on 5x5
+
+    // Captures alone are above the window, the influence map is skipped:
+    set_vertex( BLACK, 1, 1 );
+    set_black_captured(40);
+    reset_eval_cache_stats();
+    fail_unless( evaluate_position_window( value_list, -5, 5 ) == 40 - 25, "bound above window" );
+    fail_unless( value_list[5] == 0, "bouzy not evaluated" );
+    get_eval_tier_stats( &lazy, skips );
+    fail_unless( lazy == 1 && skips[1] == 1 && skips[2] == 0, "skipped after first tier" );
+
+    // Inside the window all tiers are evaluated:
+    value = evaluate_position_window( value_list, -100, 100 );
+    fail_unless( value > 40 && value_list[5] > 0, "bouzy evaluated in window" );
+    clear_eval_cache();
+    fail_unless( evaluate_position(value_list) == value, "same value as full evaluation" );
+    get_eval_tier_stats( &lazy, skips );
+    fail_unless( lazy == 2 && skips[1] == 1, "no skip in window" );
+
+    init_brains();
+    free_board();
+}
+END_TEST
+
+START_TEST ( test_search_selective )
+{
+    int i, j;
+    search_stats_t search_stats;
+
+    fail_unless( ! get_selective(SELECT_NULL_MOVE), "null move is off by default" );
+    fail_unless( ! get_selective(SELECT_LMR),       "lmr is off by default"       );
+    fail_unless( ! get_selective(SELECT_FUTILITY),  "futility is off by default"  );
+
+    set_selective( SELECT_NULL_MOVE, true );
+    set_selective( SELECT_LMR,       true );
+    set_selective( SELECT_FUTILITY,  true );
+    fail_unless( get_selective(SELECT_NULL_MOVE) && get_selective(SELECT_LMR)
+        && get_selective(SELECT_FUTILITY), "all techniques are on" );
+
+    init_board(5);
+    init_move_history();
+    init_brains();
+    init_hash_table();
+
+    set_vertex( BLACK, 1, 1 );
+    set_vertex( WHITE, 2, 1 );
+    set_vertex( WHITE, 1, 2 );
+
+    set_search_depth(3);
+    search_tree( BLACK, &i, &j );
+    search_stats = get_search_stats();
+
+    fail_unless( i != INVALID && j != INVALID, "valid move returned" );
+    fail_unless( get_vertex( i, j ) == EMPTY, "move on empty vertex" );
+    fail_unless( search_stats.lmr_count > 0, "moves reduced (%d)", search_stats.lmr_count );
+    fail_unless( get_vertex( 1, 1 ) == BLACK && get_vertex( 2, 1 ) == WHITE, "board unchanged" );
+
+    set_selective( SELECT_LMR, false );
+    fail_unless( ! get_selective(SELECT_LMR), "lmr is off" );
+    fail_unless( get_selective(SELECT_NULL_MOVE), "null move is still on" );
+
+    set_selective( SELECT_NULL_MOVE, false );
+    set_selective( SELECT_FUTILITY,  false );
+    set_search_depth(DEFAULT_SEARCH_DEPTH);
+    free_hash_table();
+    free_board();
+}
+END_TEST
+
+START_TEST ( test_search_multi_pv )
+{
+    int k;
+    int i, j;
+    int nr_of_lines;
+    pv_line_t lines[MAX_MULTI_PV];
+
+    fail_unless( get_multi_pv() == 1, "multi-pv is 1 by default" );
+
+    init_board(5);
+    init_move_history();
+    init_brains();
+    init_hash_table();
+
+    set_vertex( BLACK, 1, 1 );
+    set_vertex( WHITE, 2, 1 );
+    set_vertex( WHITE, 1, 2 );
+
+    set_multi_pv(3);
+    set_search_depth(2);
+    search_tree( BLACK, &i, &j );
+    nr_of_lines = get_pv_lines(lines);
+
+    fail_unless( nr_of_lines == 3, "three lines (%d)", nr_of_lines );
+    fail_unless( lines[0].i == i && lines[0].j == j, "first line is selected move" );
+    for ( k = 0; k < nr_of_lines; k++ ) {
+        fail_unless( lines[k].depth == 2, "depth is 2" );
+        fail_unless( lines[k].pv_length >= 1, "pv contains root move" );
+        fail_unless( lines[k].pv[0][0] == lines[k].i && lines[k].pv[0][1] == lines[k].j
+            , "pv starts with root move" );
+        if ( k > 0 ) {
+            fail_unless( lines[k].value <= lines[k-1].value, "lines sorted for black" );
+        }
+    }
+    fail_unless( get_vertex( 1, 1 ) == BLACK && get_vertex( 2, 1 ) == WHITE, "board unchanged" );
+
+    set_multi_pv(1);
+    set_search_depth(DEFAULT_SEARCH_DEPTH);
+    free_hash_table();
+    free_board();
+}
+END_TEST
+
+START_TEST ( test_search_multi_pv_tie )
+{
+    int i, j;
+    int nr_of_lines;
+    pv_line_t lines[MAX_MULTI_PV];
+
+    init_board(5);
+    init_move_history();
+    init_brains();
+    init_hash_table();
+
+    // Two white stones in atari in opposite corners; both captures are
+    // equally good:
+    set_vertex( WHITE, 0, 0 );
+    set_vertex( BLACK, 1, 0 );
+    set_vertex( WHITE, 4, 4 );
+    set_vertex( BLACK, 3, 4 );
+
+    set_multi_pv(2);
+    set_search_depth(2);
+    search_tree( BLACK, &i, &j );
+    nr_of_lines = get_pv_lines(lines);
+
+    fail_unless( nr_of_lines == 2, "two lines (%d)", nr_of_lines );
+    fail_unless( lines[0].value == lines[1].value, "equal values (%d, %d)", lines[0].value, lines[1].value );
+    fail_unless( ( lines[0].i == 0 && lines[0].j == 1 && lines[1].i == 4 && lines[1].j == 3 )
+        || ( lines[0].i == 4 && lines[0].j == 3 && lines[1].i == 0 && lines[1].j == 1 )
+        , "both captures are listed (%d,%d) (%d,%d)", lines[0].i, lines[0].j, lines[1].i, lines[1].j );
+
+    set_multi_pv(1);
+    set_search_depth(DEFAULT_SEARCH_DEPTH);
+    free_hash_table();
+    free_board();
+}
+END_TEST
+
 Suite * search_suite(void) {
     Suite *s = suite_create("Search");
 
@@ -178,6 +431,12 @@ Suite * search_suite(void) {
 
     tcase_add_test( tc_search, test_search_valid );
     tcase_add_test( tc_search, test_search_pass  );
+    tcase_add_test( tc_search, test_search_threads );
+    tcase_add_test( tc_search, test_search_eval_cache );
+    tcase_add_test( tc_search, test_search_eval_window );
+    tcase_add_test( tc_search, test_search_selective );
+    tcase_add_test( tc_search, test_search_multi_pv );
+    tcase_add_test( tc_search, test_search_multi_pv_tie );
 
     suite_add_tcase( s, tc_misc   );
     suite_add_tcase( s, tc_search );